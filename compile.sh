@@ -1 +1,65 @@
-g++ -std=c++23 -Wall -Wpedantic source/video.cpp source/main.cpp -Iinclude -I3rdparty -lncurses
+#!/bin/sh
+#usage: ./compile.sh [app|batch|bench|player|viewer|all]
+#the engine sources are built once into build/libasciicam.a and linked into the app, the batch renderer, the benchmark, the player and the viewer
+#set PROFILE=1 to compile in the profiler zones, eg. PROFILE=1 ./compile.sh
+#set ARENA_DEBUG=1 to count the frame arenas' usage into the stats and poison their memory between frames
+#set NATIVE=1 to target the building machine's instruction set, which turns on the matrix library's AVX paths where available
+
+set -e
+
+CXX=${CXX:-g++}
+#-fopenmp-simd only honors "#pragma omp simd" on loops written to vectorize. it doesn't link in OpenMP or start any threads
+CXXFLAGS="-std=c++23 -Wall -Wpedantic -O2 -fopenmp-simd -Iinclude -I3rdparty"
+#the wide build of ncurses is the one with the extended color calls, which 24-bit colors need
+LIBS="-lncursesw -pthread"
+if [ "${PROFILE:-0}" = "1" ]; then
+	CXXFLAGS="$CXXFLAGS -DASCIICAM_PROFILE"
+fi
+if [ "${ARENA_DEBUG:-0}" = "1" ]; then
+	CXXFLAGS="$CXXFLAGS -DASCIICAM_ARENA_DEBUG"
+fi
+if [ "${NATIVE:-0}" = "1" ]; then
+	CXXFLAGS="$CXXFLAGS -march=native"
+fi
+SOURCES="video palette renderer overlay model simplify optimize level jobs arena profiler stats framecodec recorder broadcaster animation occlusion depthbuffer pointcloud assets governor"
+
+lib() {
+	mkdir -p build
+	OBJECTS=""
+	for name in $SOURCES; do
+		$CXX $CXXFLAGS -c source/$name.cpp -o build/$name.o
+		OBJECTS="$OBJECTS build/$name.o"
+	done
+	rm -f build/libasciicam.a
+	ar rcs build/libasciicam.a $OBJECTS
+}
+
+app() {
+	$CXX $CXXFLAGS source/main.cpp build/libasciicam.a -o build/asciicam $LIBS
+}
+
+batch() {
+	$CXX $CXXFLAGS source/batch.cpp build/libasciicam.a -o build/batch $LIBS
+}
+
+player() {
+	$CXX $CXXFLAGS source/player.cpp build/libasciicam.a -o build/player $LIBS
+}
+
+viewer() {
+	$CXX $CXXFLAGS source/viewer.cpp build/libasciicam.a -o build/viewer $LIBS
+}
+
+bench() {
+	$CXX $CXXFLAGS testing/bench.cpp build/libasciicam.a -o build/bench $LIBS
+}
+
+case "${1:-app}" in
+	app) lib; app ;;
+	batch) lib; batch ;;
+	bench) lib; bench ;;
+	player) lib; player ;;
+	viewer) lib; viewer ;;
+	all) lib; app; batch; bench; player; viewer ;;
+	*) echo "usage: $0 [app|batch|bench|player|viewer|all]"; exit 1 ;;
+esac
@@ -0,0 +1,57 @@
+//Nick Sells, 2024
+
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include "level.h"
+
+//describes a simple procedural motion: the object orbits center about axis at speed radians per second,
+//sitting at offset from the center plus a sinusoidal bob of the given amplitude, frequency (radians per second) and phase
+//ie. world = translate(center) * rotate(speed * t, axis) * translate(offset + amplitude * sin(frequency * t + phase))
+struct AnimationParams {
+	glm::vec3 center;
+	glm::vec3 axis;
+	float speed;
+	glm::vec3 offset;
+	glm::vec3 amplitude;
+	float frequency;
+	float phase;
+};
+
+//animates many level objects at once. the parameters are stored one array per component so that Update
+//can evaluate every object with the same straight-line code, which the compiler can vectorize, spread across the job pool
+class Animation {
+
+private:
+	std::vector<ObjectHandle> targets;
+	std::vector<float> centerX, centerY, centerZ;
+	std::vector<float> axisX, axisY, axisZ;
+	std::vector<float> speed;
+	std::vector<float> offsetX, offsetY, offsetZ;
+	std::vector<float> amplitudeX, amplitudeY, amplitudeZ;
+	std::vector<float> frequency;
+	std::vector<float> phase;
+
+	std::vector<glm::mat4> results;
+
+	void Evaluate(size_t begin, size_t end, float time);
+
+public:
+	//starts animating an object and returns its index in this animation
+	size_t Add(ObjectHandle target, const AnimationParams& params);
+	//stops animating by index. the last entry moves into the hole, so indices past it are not stable
+	void Remove(size_t index);
+
+	inline size_t GetCount(void) const {
+		return targets.size();
+	}
+
+	//evaluates every animation at the given time and writes the results into the level
+	void Update(Level& level, float time);
+};
+
+#endif
@@ -0,0 +1,61 @@
+//Nick Sells, 2024
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+//scratch memory that lasts until the end of the frame, for data a frame builds and throws away
+//each thread bumps a pointer through an arena of its own, so allocating never takes a lock or touches the heap once
+//the arena has grown to fit a frame. nothing is freed on its own: EndFrame lets every arena start over, in constant time
+//NOTE: memory from the arena, and any container using Allocator, must not be kept past the end of the frame
+namespace Arena {
+
+	//threads past this many still get arenas, but their usage isn't reported
+	static const unsigned int MAX_THREADS = 256;
+	//the smallest block an arena grows by
+	static const size_t BLOCK_SIZE = 64 * 1024;
+
+	//bump-allocates from the calling thread's arena. align must be a power of two no bigger than alignof(max_align_t)
+	extern void* Allocate(size_t size, size_t align);
+
+	//ends the frame for every arena. call from the main thread while no jobs are running
+	//each arena actually rewinds the next time its thread allocates, and an arena that needed more than one block
+	//is swapped for a single block big enough for the whole frame, so that it stops growing once frames settle
+	extern void EndFrame(void);
+
+	//the bytes handed out over every thread in the frame just ended, and the most in any frame so far
+	//only counted when built with ASCIICAM_ARENA_DEBUG, which also reports them to Stats and fills rewound blocks with
+	//garbage so that anything kept past its frame shows up quickly. both are zero otherwise
+	extern size_t GetFrameBytes(void);
+	extern size_t GetPeakBytes(void);
+
+	//lets standard containers allocate from the calling thread's arena. deallocating does nothing
+	template <typename T>
+	struct Allocator {
+		typedef T value_type;
+
+		inline Allocator(void) = default;
+		template <typename U>
+		inline Allocator(const Allocator<U>&) {
+		}
+
+		inline T* allocate(size_t n) {
+			return (T*) Allocate(n * sizeof(T), alignof(T));
+		}
+
+		inline void deallocate(T*, size_t) {
+		}
+
+		template <typename U>
+		inline bool operator==(const Allocator<U>&) const {
+			return true;
+		}
+	};
+
+	template <typename T>
+	using Vector = std::vector<T, Allocator<T>>;
+};
+
+#endif
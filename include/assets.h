@@ -0,0 +1,110 @@
+//Nick Sells, 2024
+
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "level.h"
+#include "model.h"
+
+//loads models and levels on background threads, so that nothing waits on a file until it is actually needed
+//a model's handle is usable right away: until the model arrives the level holds an empty placeholder, which draws nothing.
+//finished loads are only ever installed by Update, so a frame always sees a consistent set of assets.
+//a directory is watched with inotify, and any asset whose file changes there is reloaded and swapped in the same way
+class Assets {
+private:
+	struct ModelAsset {
+		std::string path;
+		bool quantize;
+		Level* level;
+		ModelHandle handle;
+		unsigned long generation; //of the latest load requested, so that a slow, stale load can't replace a newer one
+	};
+
+	struct LevelAsset {
+		std::string path;
+		Level* level;
+		std::vector<ObjectHandle> objects; //placed by the map's last successful load
+		unsigned long generation;
+	};
+
+	struct Request {
+		bool isLevel;
+		size_t asset;
+		unsigned long generation;
+		std::string path;
+		bool quantize;
+	};
+
+	struct Result {
+		bool isLevel;
+		size_t asset;
+		unsigned long generation;
+		std::optional<Model> model;
+		std::vector<Level::MapEntry> entries;
+		std::string error; //empty if the load worked
+	};
+
+	std::vector<ModelAsset> models;
+	std::vector<LevelAsset> levels;
+	size_t pending; //requests whose results haven't been installed yet
+	std::string lastError;
+
+	//the loaders take requests from the front of the queue and put results at the back of finished
+	std::vector<std::thread> loaders;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<Request> requests;
+	std::vector<Result> finished;
+	bool stopping;
+
+	std::string watchDirectory;
+	int watchFd; //-1 if watching isn't possible
+
+	void LoaderLoop(void);
+	void Queue(bool isLevel, size_t asset);
+	void Install(Result& result);
+	//queues a reload of every asset loaded from path
+	void Reload(const std::string& path);
+	void PollWatch(void);
+
+public:
+	//starts the loaders and watches a directory for changes. zero threads means half the hardware threads, at least one
+	//if the directory can't be watched, everything still loads but nothing hot-reloads
+	Assets(const std::string& watchDirectory = "data", unsigned int threads = 0);
+	//abandons whatever hasn't loaded yet and stops the loaders
+	~Assets();
+
+	Assets(const Assets&) = delete;
+	Assets& operator=(const Assets&) = delete;
+
+	//adds a placeholder to the level and starts loading the model from an .obj file to replace it
+	//loading the same path into the same level again returns the same handle
+	ModelHandle LoadModel(Level& level, const std::string& path, bool quantize = false);
+
+	//starts reading a .map file. its objects are added to the level once it has been read, with their models loading
+	//in the background like any other. when the map changes, the objects it placed are replaced with the new ones
+	void LoadLevel(Level& level, const std::string& path);
+
+	//installs everything that has finished loading and queues reloads of any files that changed. call between frames
+	void Update(void);
+
+	//how many loads are still in flight
+	inline size_t GetPendingCount(void) const {
+		return pending;
+	}
+
+	//what went wrong with the most recent load that failed, or empty if none have. a failed reload keeps the old asset
+	inline const std::string& GetLastError(void) const {
+		return lastError;
+	}
+};
+
+#endif
@@ -0,0 +1,63 @@
+//Nick Sells, 2024
+
+#ifndef BROADCASTER_H
+#define BROADCASTER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "framecodec.h"
+
+//serves every presented frame to any number of viewers connected to a local unix socket
+//each frame is delta-encoded once and the same bytes go to every viewer, so extra viewers cost little more than a copy
+//sockets are never waited on: a viewer that falls behind has frames dropped and is resynced with a keyframe when it catches up
+class Broadcaster {
+private:
+	struct Client {
+		int fd;
+		std::vector<unsigned char> queued; //bytes the socket hasn't taken yet
+		size_t sent; //how much of queued has gone out
+		bool resync; //frames were dropped, so the next thing this client gets must be a keyframe
+		bool joined; //the stream header has been queued
+	};
+
+	std::string path;
+	int listener;
+	std::vector<Client> clients;
+	FrameCodec::Encoder encoder;
+	uint64_t startTime;
+	std::vector<unsigned char> delta;
+	std::vector<unsigned char> keyframe;
+	unsigned long dropped;
+
+	void Accept(void);
+	//sends as much of a client's queue as the socket takes right now. returns false if the client has gone away
+	bool Flush(Client& client);
+
+public:
+	//a viewer with more than this many bytes still unsent stops getting frames until it drains
+	static const size_t MAX_QUEUED = 256 * 1024;
+
+	//listens on a unix socket at path, replacing anything already there. throws if it can't
+	Broadcaster(const std::string& path);
+	//disconnects every viewer and removes the socket
+	~Broadcaster();
+
+	Broadcaster(const Broadcaster&) = delete;
+	Broadcaster& operator=(const Broadcaster&) = delete;
+
+	//encodes a frame and sends it to every viewer, accepting any that have connected since the last frame
+	void Capture(const Video::Cell* cells, int width, int height);
+
+	inline size_t GetClientCount(void) const {
+		return clients.size();
+	}
+
+	//how many frames have been dropped across all viewers so far
+	inline unsigned long GetDroppedCount(void) const {
+		return dropped;
+	}
+};
+
+#endif
@@ -3,9 +3,21 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 
+#include <algorithm>
 #include <iostream>
+#include <utility>
+#include <vector>
 
+#include "config.h"
+#include "gameobject.h"
 #include "level.h"
+#include "occlusion.h"
+#include "pointcloud.h"
+#include "profiler.h"
+#include "renderer.h"
+#include "stats.h"
+#include "transform.h"
+#include "util.h"
 #include "video.h"
 
 #include <glm/ext/matrix_transform.hpp>
@@ -13,99 +25,451 @@
 
 class Camera {
 
+private:
+	//what the cached matrices were last built from
+	unsigned long viewVersion;
+	glm::vec4 projectionParams;
+
+	//what Render(level) made of an object last time, so that an object that hasn't changed, seen by a camera that
+	//hasn't moved, can be culled and drawn again without transforming a single vertex
+	struct CachedObject {
+		unsigned int owner; //the level slot this was made for, since removals move objects between dense indices
+		unsigned long version; //unique across levels, so a level rebuilt at the same address can't match a stale entry
+		bool culled;
+		bool projected; //culled objects aren't projected until they come into view
+		int lod; //index into the model's lods, or -1 for the model itself
+		std::vector<glm::vec3> screenVerts;
+	};
+
+	//the cache, by dense index, and everything about the camera and level it holds for
+	const Level* cachedLevel;
+	glm::mat4 cachedViewProjection;
+	Video::Viewport cachedViewport;
+	float cachedLodBias;
+	bool cachedOcclusion;
+	std::vector<CachedObject> cache;
+	std::vector<std::pair<unsigned int, unsigned long>> cachedOccluders; //owner and version of each visible occluder
+	std::vector<std::pair<unsigned int, unsigned long>> occluderKeys; //this frame's, to compare against
+
+	//scratch space for drawing models outside of a level
+	std::vector<glm::vec3> screenScratch;
+
 public:
-	glm::mat4 transform;
+	Transform transform;
 	float fov;
 	float near;
 	float far;
 
+	//the part of the screen this camera draws into. zero width or height means the whole screen
+	Video::Viewport viewport;
+
 	glm::mat4 view;
 	glm::mat4 projection;
+	glm::mat4 viewProjection;
 
+	//scales the triangles a LOD may spend per cell. below one picks coarser LODs, eg. to save time on a heavy frame
+	float lodBias;
+
+	//whether Render(level) draws the level's occluders into the occlusion buffer and skips whatever they hide
+	bool occlusionCulling;
+	OcclusionBuffer occlusion;
+
+	//where point clouds are counted up before being shaded
+	DensityBuffer density;
+
+	//the six clip planes of the view frustum in world space, normalized, pointing inward
+	glm::vec4 frustum[6];
+
+	//the camera never carries scale, so its view matrix is a cheap rigid-body inverse rather than a full glm::inverse
 	inline void UpdateView() {
-		view = glm::inverse(transform);
+		const glm::mat4& world = transform.GetWorld();
+		if (transform.GetVersion() == viewVersion)
+			return;
+		view = Util::RigidInverse(world);
+		viewVersion = transform.GetVersion();
+	}
+
+	//the viewport with the whole-screen default filled in
+	inline Video::Viewport GetViewport() const {
+		return (viewport.width > 0 && viewport.height > 0) ? viewport : Video::GetScreenViewport();
 	}
 
 	inline void UpdatePerspective() {
-		projection = glm::perspective(glm::radians(fov), Video::GetAspectRatio(), near, far);
+		//halved like Video::GetAspectRatio, since cells are about twice as tall as they are wide
+		Video::Viewport vp = GetViewport();
+		glm::vec4 params(fov, (0.5f * vp.width) / std::max(vp.height, 1), near, far);
+		if (params == projectionParams)
+			return;
+		projection = glm::perspective(glm::radians(fov), params.y, near, far);
+		projectionParams = params;
 	}
 
-	//typical member-wise constructor
-	inline Camera(const glm::mat4& transform, float fov, float near, float far):
-	transform(transform), fov(fov), near(near), far(far) {
+	//refreshes whichever matrices are stale and combines them. call once per frame before any Render calls
+	inline void BeginFrame() {
 		UpdateView();
 		UpdatePerspective();
+		viewProjection = projection * view;
+
+		//extract the frustum planes from the rows of the view-projection matrix (Gribb & Hartmann)
+		glm::vec4 rows[4];
+		for (int r = 0; r < 4; r++)
+			rows[r] = glm::vec4(viewProjection[0][r], viewProjection[1][r], viewProjection[2][r], viewProjection[3][r]);
+		for (int i = 0; i < 3; i++) {
+			frustum[2*i] = rows[3] + rows[i];
+			frustum[2*i+1] = rows[3] - rows[i];
+		}
+		for (auto& plane : frustum)
+			plane = plane / glm::length(glm::vec3(plane));
+	}
+
+	//true if any part of a world-space bounding sphere (center in xyz, radius in w) could be on screen
+	inline bool IsVisible(const glm::vec4& sphere) const {
+		for (const auto& plane : frustum)
+			if (glm::dot(glm::vec3(plane), glm::vec3(sphere)) + plane.w < -sphere.w)
+				return false;
+		return true;
+	}
+
+	//typical member-wise constructor
+	inline Camera(const glm::mat4& transform, float fov, float near, float far):
+	viewVersion(0), projectionParams(0.0f), cachedLevel(nullptr), transform(transform), fov(fov), near(near), far(far), viewport{0, 0, 0, 0}, lodBias(1.0f), occlusionCulling(true) {
+		BeginFrame();
 	}
 
 	inline Camera (const glm::vec3& position, float fov, float near, float far):
-	transform(glm::mat4(1.0f)), fov(fov), near(near), far(far) {
-		transform[3] = glm::vec4(position, 1.0f); 
+	Camera(glm::translate(glm::mat4(1.0f), position), fov, near, far) {
 	}
 
-	inline void Render(const GameObject& gobj) {
+	//picks the coarsest LOD that still has enough triangles for the number of cells the model covers on screen
+	//takes the object's world-space bounding sphere, which the level keeps up to date, so that nothing about the object
+	//itself has to be recomputed for each camera looking at it
+	inline const Model& SelectLod(const Model& model, const glm::vec4& sphere) const {
+		if (model.lods.empty())
+			return model;
 
-		UpdateView();
-		UpdatePerspective();
+		//distance in front of the camera. anything reaching behind the near plane gets full detail
+		float depth = -(view * glm::vec4(glm::vec3(sphere), 1.0f)).z;
+		if (depth - sphere.w <= near)
+			return model;
+		float projectedRadius = sphere.w * projection[1][1] * 0.5f * GetViewport().height / depth;
+
+		float budget = 3.14159265f * projectedRadius * projectedRadius * Config::lodTrianglesPerCell * lodBias;
+		const Model* chosen = &model;
+		for (const Model& lod : model.lods) {
+			if (chosen->GetPrimitiveCount() <= budget)
+				break;
+			chosen = &lod;
+		}
+		return *chosen;
+	}
+
+	static inline glm::vec4 ToPoint(const glm::vec3& v) {
+		return glm::vec4(v, 1.0f);
+	}
 
-		//pre-calculate the combined transformation matrix
-		glm::mat4 PVM = (projection * view) * gobj.transform;
-		
-		std::size_t numVerts = gobj.mesh.verts.size();
-		glm::vec4* clipVerts = new glm::vec4[numVerts];
-		glm::vec3* ndcVerts = new glm::vec3[numVerts];
-		glm::vec3* screenVerts = new glm::vec3[numVerts]; //vec3 bc we need the depth too
-		bool* visible = new bool[numVerts];
+	static inline glm::vec4 ToPoint(const QuantizedVert& v) {
+		return glm::vec4((float) v.x, (float) v.y, (float) v.z, 1.0f);
+	}
+
+	//the world-space bounding sphere of model-space bounds placed by a transform, for objects that don't live in a level
+	static inline glm::vec4 GetBoundingSphere(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& world) {
+		glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+		float radius = glm::length(boundsMax - center);
+		float scale = 0.0f;
+		for (int i = 0; i < 3; i++)
+			scale = std::max(scale, glm::length(glm::vec3(world[i])));
+		return glm::vec4(glm::vec3(world * glm::vec4(center, 1.0f)), radius * scale);
+	}
 
-		//send each vertex through the pipeline
+	//transforms verts all the way to screen space. x and y are in cells within the viewport, z is the reciprocal of view-space depth
+	template <typename Vert>
+	static inline void Project(const glm::mat4& PVM, const Vert* verts, size_t numVerts, glm::vec3* screenVerts, const Video::Viewport& viewport) {
+		float left = viewport.x;
+		float top = viewport.y;
+		float width = viewport.width;
+		float height = viewport.height;
 		for(size_t i = 0; i < numVerts; i++) {
 			//convert to clip space
-			clipVerts[i] = PVM * glm::vec4(gobj.mesh.verts[i], 1.0f);
+			glm::vec4 clip = PVM * ToPoint(verts[i]);
 			//convert to normalized device coordinates
-			ndcVerts[i] = clipVerts[i] / clipVerts[i].w;
+			glm::vec3 ndc = glm::vec3(clip) / clip.w;
 			//convert to screen space coordinates
-			screenVerts[i].x = (ndcVerts[i].x + 1.0f) * 0.5f * Video::GetScreenWidth();
-			screenVerts[i].y = (1.0f - ndcVerts[i].y) * 0.5f * Video::GetScreenHeight();				
-			//the vertex is only visible if it lies within the unit cube of -1.0 to 1.0
-			visible[i] = (abs(ndcVerts[i].x) < 1.0f) && (abs(ndcVerts[i].y) < 1.0f) && (abs(ndcVerts[i].z) < 1.0f);
+			screenVerts[i].x = left + (ndc.x + 1.0f) * 0.5f * width;
+			screenVerts[i].y = top + (1.0f - ndc.y) * 0.5f * height;
+			//keep the reciprocal of the view-space depth, since unlike depth it interpolates linearly across the screen
+			screenVerts[i].z = 1.0f / clip.w;
+		}
+	}
+
+	//each index after the first in a run adds one line from the vertex before it
+	static inline void RenderLineStrips(const glm::vec3* screenVerts, const unsigned short* indices, size_t numIndices, bool loop) {
+		const glm::vec3* first = nullptr;
+		const glm::vec3* prev = nullptr;
+		for (size_t i = 0; i <= numIndices; i++) {
+			if (i == numIndices || indices[i] == Model::RESTART_INDEX) {
+				if (loop && first != nullptr && prev != first)
+					Renderer::SubmitLine(*prev, *first);
+				first = prev = nullptr;
+				continue;
+			}
+			const glm::vec3* cur = &screenVerts[indices[i]];
+			if (prev != nullptr)
+				Renderer::SubmitLine(*prev, *cur);
+			else
+				first = cur;
+			prev = cur;
 		}
+	}
+
+	//neighboring triangles in a strip share an edge, so after the first triangle each index only adds the two edges
+	//from the previous two verts to the new one instead of a whole triangle outline
+	static inline void RenderTriangleStrips(const glm::vec3* screenVerts, const unsigned short* indices, size_t numIndices) {
+		const glm::vec3* a = nullptr;
+		const glm::vec3* b = nullptr;
+		for (size_t i = 0; i < numIndices; i++) {
+			if (indices[i] == Model::RESTART_INDEX) {
+				a = b = nullptr;
+				continue;
+			}
+			const glm::vec3* c = &screenVerts[indices[i]];
+			if (b == nullptr) {
+				b = c;
+				continue;
+			}
+			if (a == nullptr)
+				Renderer::SubmitLine(*b, *c);
+			else {
+				Renderer::SubmitLine(*a, *c);
+				Renderer::SubmitLine(*b, *c);
+			}
+			a = b;
+			b = c;
+		}
+	}
 
-		size_t numIndices = gobj.mesh.indices.size();
-		switch (gobj.mesh.renderingPrimitive) {
+	//fills a model's triangles into the renderer's depth buffer so they can hide lines in hidden-line mode
+	static inline void SubmitSurfaces(const glm::vec3* screenVerts, const Model& mesh) {
+		const unsigned short* indices = mesh.indices.data();
+		size_t n = mesh.indices.size();
+		switch (mesh.renderingPrimitive) {
+			case Model::Primitive::Triangles:
+				for (size_t i = 0; i + 2 < n; i += 3)
+					Renderer::SubmitSurface(screenVerts[indices[i]], screenVerts[indices[i+1]], screenVerts[indices[i+2]]);
+				break;
+			case Model::Primitive::Quads:
+				for (size_t i = 0; i + 3 < n; i += 4) {
+					Renderer::SubmitSurface(screenVerts[indices[i]], screenVerts[indices[i+1]], screenVerts[indices[i+2]]);
+					Renderer::SubmitSurface(screenVerts[indices[i]], screenVerts[indices[i+2]], screenVerts[indices[i+3]]);
+				}
+				break;
+			case Model::Primitive::TriangleStrip:
+				for (size_t i = 0; i + 2 < n; i++) {
+					if (indices[i] == Model::RESTART_INDEX || indices[i+1] == Model::RESTART_INDEX || indices[i+2] == Model::RESTART_INDEX)
+						continue;
+					Renderer::SubmitSurface(screenVerts[indices[i]], screenVerts[indices[i+1]], screenVerts[indices[i+2]]);
+				}
+				break;
+			default:
+				break; //points and lines have no surface to hide anything behind
+		}
+	}
+
+	inline void Render(const GameObject& gobj) {
+		Stats::Add(Stats::ObjectsSubmitted);
+		const glm::mat4& world = gobj.transform.GetWorld();
+		Renderer::SetViewport(GetViewport());
+		RenderModel(gobj.mesh, world, GetBoundingSphere(gobj.mesh.boundsMin, gobj.mesh.boundsMax, world));
+		Renderer::ResetViewport();
+	}
+
+	//draws a point cloud as a density map over this camera's viewport, shading each cell by how many points land in it
+	inline void Render(const PointCloud& cloud, const glm::mat4& world) {
+		PROFILE_ZONE("Camera::Render cloud");
+		Stats::Add(Stats::ObjectsSubmitted);
+		glm::vec4 sphere = GetBoundingSphere(cloud.boundsMin, cloud.boundsMax, world);
+		if (!IsVisible(sphere)) {
+			Stats::Add(Stats::ObjectsCulled);
+			return;
+		}
+		Renderer::SetViewport(GetViewport());
+		density.Clear(GetViewport());
+		density.Splat(cloud, viewProjection * world);
+		density.Submit(1.0f / std::max(-(view * glm::vec4(glm::vec3(sphere), 1.0f)).z, near));
+		Renderer::ResetViewport();
+	}
+
+	//forgets everything Render(level) has cached, so that the next call projects every object afresh
+	inline void InvalidateCache() {
+		cachedLevel = nullptr;
+	}
+
+	//culls and renders every object in a level, streaming through its arrays in order
+	//with occlusion culling on, visible occluders are drawn into the occlusion buffer first,
+	//and every other object must pass a test against it before it gets transformed
+	//while the camera stays put, objects whose version hasn't changed reuse last call's culling and screen-space verts,
+	//and the occlusion buffer is only redrawn when an occluder changes
+	//the level's transforms and bounds are only read, so any number of cameras can render the same level each frame
+	inline void Render(const Level& level) {
+		PROFILE_ZONE("Camera::Render");
+		Video::Viewport vp = GetViewport();
+		const auto& transforms = level.GetTransforms();
+		const auto& spheres = level.GetSpheres();
+		const auto& meshes = level.GetMeshes();
+		const auto& occluders = level.GetOccluders();
+		const auto& versions = level.GetVersions();
+		const auto& owners = level.GetOwners();
+		size_t n = level.GetObjectCount();
+		Stats::Add(Stats::ObjectsSubmitted, n);
+
+		bool occlude = occlusionCulling && level.GetOccluderCount() > 0;
+		bool still = cachedLevel == &level && cachedViewProjection == viewProjection && cachedViewport == vp
+			&& cachedLodBias == lodBias && cachedOcclusion == occlude;
+		if (!still) {
+			cachedLevel = &level;
+			cachedViewProjection = viewProjection;
+			cachedViewport = vp;
+			cachedLodBias = lodBias;
+			cachedOcclusion = occlude;
+		}
+		cache.resize(n);
+
+		//an occluder moving can hide or reveal anything, so every object is tested again when one does
+		bool occludersStill = still;
+		if (occlude) {
+			occluderKeys.clear();
+			for (size_t i = 0; i < n; i++)
+				if (occluders[i] && IsVisible(spheres[i]))
+					occluderKeys.emplace_back(owners[i], versions[i]);
+			occludersStill = still && occluderKeys == cachedOccluders;
+			if (!occludersStill) {
+				PROFILE_ZONE("occluders");
+				occlusion.Clear(vp.width, vp.height);
+				for (size_t i = 0; i < n; i++)
+					if (occluders[i] && IsVisible(spheres[i]))
+						occlusion.AddOccluder(level.GetModel(meshes[i]), viewProjection * transforms[i], near);
+				occlusion.BuildHierarchy();
+				cachedOccluders.swap(occluderKeys);
+			}
+		}
+
+		size_t culled = 0;
+		size_t reused = 0;
+		Renderer::SetViewport(vp);
+		for (size_t i = 0; i < n; i++) {
+			CachedObject& entry = cache[i];
+			bool same = still && entry.owner == owners[i] && entry.version == versions[i];
+			if (!same) {
+				entry.owner = owners[i];
+				entry.version = versions[i];
+				entry.projected = false;
+			}
+			if (!same || !occludersStill)
+				entry.culled = !IsVisible(spheres[i]) || (occlude && !occluders[i] && occlusion.IsOccluded(spheres[i], viewProjection, near));
+			if (entry.culled) {
+				culled++;
+				continue;
+			}
+
+			const Model& model = level.GetModel(meshes[i]);
+			if (entry.projected)
+				reused++;
+			else {
+				const Model& mesh = SelectLod(model, spheres[i]);
+				entry.lod = (&mesh == &model) ? -1 : (int) (&mesh - model.lods.data());
+				ProjectModel(mesh, transforms[i], entry.screenVerts);
+				entry.projected = true;
+			}
+			DrawModel((entry.lod < 0) ? model : model.lods[entry.lod], entry.screenVerts.data());
+		}
+		Renderer::ResetViewport();
+		Stats::Add(Stats::ObjectsCulled, culled);
+		Stats::Add(Stats::ObjectsReused, reused);
+	}
+
+	//draws a model into the renderer's current viewport, which should be this camera's
+	inline void RenderModel(const Model& model, const glm::mat4& world, const glm::vec4& sphere) {
+		const Model& mesh = SelectLod(model, sphere);
+		ProjectModel(mesh, world, screenScratch);
+		DrawModel(mesh, screenScratch.data());
+	}
+
+	//transforms a model's verts to screen space within this camera's viewport
+	inline void ProjectModel(const Model& mesh, const glm::mat4& world, std::vector<glm::vec3>& screenVerts) {
+		std::size_t numVerts = mesh.GetVertexCount();
+		screenVerts.resize(numVerts); //vec3 bc we need the depth too
+		if (numVerts == 0)
+			return; //eg. the placeholder for a model that is still loading
+		Stats::Add(Stats::VerticesTransformed, numVerts);
+
+		//send each vertex through the pipeline. quantized models fold their dequantization into the matrix
+		//the combined matrix starts from the view-projection, which is shared by every draw this frame
+		glm::mat4 PVM = viewProjection * world;
+		Video::Viewport vp = GetViewport();
+		if (mesh.IsQuantized())
+			Project(PVM * mesh.GetDequantization(), mesh.quantizedVerts.data(), numVerts, screenVerts.data(), vp);
+		else
+			Project(PVM, mesh.verts.data(), numVerts, screenVerts.data(), vp);
+	}
+
+	//submits a model's primitives, given its verts already in screen space
+	static inline void DrawModel(const Model& mesh, const glm::vec3* screenVerts) {
+		if (Renderer::GetHiddenLines())
+			SubmitSurfaces(screenVerts, mesh);
+
+		size_t numIndices = mesh.indices.size();
+		const unsigned short* indices = mesh.indices.data();
+		switch (mesh.renderingPrimitive) {
 			case Model::Primitive::Points:
 				for (size_t i = 0; i < numIndices; i++) {
-					const auto& v0 = screenVerts[gobj.mesh.indices[i]];
-					Video::PlotPixel(v0.x, v0.y);
+					if (indices[i] == Model::RESTART_INDEX)
+						continue;
+					const auto& v0 = screenVerts[indices[i]];
+					Renderer::SubmitPoint(v0);
 				}
 				break;
 			case Model::Primitive::Lines:
 				if (numIndices % 2 != 0)
 					throw std::runtime_error("number of indices is not a multiple of two required for line rendering");
 				for (size_t i = 0; i < numIndices; i += 2) {
-					const auto& v0 = screenVerts[gobj.mesh.indices[i]];
-					const auto& v1 = screenVerts[gobj.mesh.indices[i+1]];
-					Video::PlotLine(v0.x, v0.y, v1.x, v1.y);
+					const auto& v0 = screenVerts[indices[i]];
+					const auto& v1 = screenVerts[indices[i+1]];
+					Renderer::SubmitLine(v0, v1);
 				}
 				break;
 			case Model::Primitive::Triangles:
-				if (numIndices % 2 != 0)
+				if (numIndices % 3 != 0)
 					throw std::runtime_error("number of indices is not a multiple of three required for triangle rendering");
 				for (size_t i = 0; i < numIndices; i += 3) {
-					const auto& v0 = screenVerts[gobj.mesh.indices[i]];
-					const auto& v1 = screenVerts[gobj.mesh.indices[i+1]];
-					const auto& v2 = screenVerts[gobj.mesh.indices[i+2]];
-					Video::PlotLine(v0.x, v0.y, v1.x, v1.y);
-					Video::PlotLine(v1.x, v1.y, v2.x, v2.y);
-					Video::PlotLine(v2.x, v2.y, v0.x, v0.y);
+					const auto& v0 = screenVerts[indices[i]];
+					const auto& v1 = screenVerts[indices[i+1]];
+					const auto& v2 = screenVerts[indices[i+2]];
+					Renderer::SubmitTriangle(v0, v1, v2);
 				}
 				break;
+			case Model::Primitive::Quads:
+				if (numIndices % 4 != 0)
+					throw std::runtime_error("number of indices is not a multiple of four required for quad rendering");
+				for (size_t i = 0; i < numIndices; i += 4) {
+					const auto& v0 = screenVerts[indices[i]];
+					const auto& v1 = screenVerts[indices[i+1]];
+					const auto& v2 = screenVerts[indices[i+2]];
+					const auto& v3 = screenVerts[indices[i+3]];
+					Renderer::SubmitLine(v0, v1);
+					Renderer::SubmitLine(v1, v2);
+					Renderer::SubmitLine(v2, v3);
+					Renderer::SubmitLine(v3, v0);
+				}
+				break;
+			case Model::Primitive::LineStrip:
+			case Model::Primitive::LineLoop:
+				RenderLineStrips(screenVerts, indices, numIndices, mesh.renderingPrimitive == Model::Primitive::LineLoop);
+				break;
+			case Model::Primitive::TriangleStrip:
+				RenderTriangleStrips(screenVerts, indices, numIndices);
+				break;
 			default:
 				throw std::runtime_error("unknown rendering primitive");
 		}
-
-		delete[] clipVerts;
-		delete[] ndcVerts;
-		delete[] screenVerts;
-		delete[] visible;
 	}
 };
 
@@ -6,7 +6,9 @@
 
 namespace Config {
 
-	//Add stuff
+	//how many triangles a LOD may spend per screen cell covered by the model's bounding sphere
+	//a cell can show at most one glyph, so anything much above one triangle per cell is wasted work
+	static const float lodTrianglesPerCell = 0.5f;
 }
 
 #endif
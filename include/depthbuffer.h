@@ -0,0 +1,48 @@
+//Nick Sells, 2024
+
+#ifndef DEPTHBUFFER_H
+#define DEPTHBUFFER_H
+
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+//one depth per screen cell, used to hide the parts of lines that lie behind solid surfaces
+//depths are stored as reciprocal view-space depth (1/w): it interpolates linearly across the screen, and bigger is nearer
+class DepthBuffer {
+
+private:
+	int width;
+	int height;
+	std::vector<float> depth;
+
+public:
+	//how far behind a surface, relative to its depth, a line may be and still be drawn
+	//edges lie exactly on the surfaces they border, so without some slack they would hide themselves
+	static constexpr float BIAS = 0.01f;
+
+	inline DepthBuffer(void):
+	width(0), height(0) {
+	}
+
+	//sizes the buffer and pushes every cell infinitely far away
+	void Clear(int width, int height);
+
+	//fills the cells whose centers the triangle covers, keeping the nearest depth in each
+	//takes screen-space x and y and reciprocal depth in z. only cells inside the rectangle from (clipX, clipY) of size
+	//clipWidth by clipHeight are touched, so that surfaces in one viewport never hide lines in another
+	void FillTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, int clipX, int clipY, int clipWidth, int clipHeight);
+
+	inline void FillTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+		FillTriangle(a, b, c, 0, 0, width, height);
+	}
+
+	//true if something at reciprocal depth invDepth in the cell (x, y) would be visible
+	inline bool Test(int x, int y, float invDepth) const {
+		if (x < 0 || y < 0 || x >= width || y >= height)
+			return true;
+		return invDepth * (1.0f + BIAS) >= depth[(size_t) y * width + x];
+	}
+};
+
+#endif
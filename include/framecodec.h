@@ -0,0 +1,75 @@
+//Nick Sells, 2024
+
+#ifndef FRAMECODEC_H
+#define FRAMECODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "video.h"
+
+//the compact frame encoding shared by recordings and broadcasts
+//each frame is stored as the spans of cells that changed since the frame before, with runs of identical cells collapsed.
+//a keyframe stores the whole frame, so decoding can start from it without anything that came before
+//
+//stream layout, all integers little-endian:
+//	header: "ACRC", u8 version
+//	frame: u8 flags (bit 0 = keyframe), u64 microseconds since the stream started, u16 width, u16 height, u32 payload size, payload
+//	payload: spans of varint cells to skip, varint span length, then runs covering the span of varint length, u8 char, varint color pair
+namespace FrameCodec {
+
+	static const uint8_t VERSION = 1;
+	static const uint8_t KEYFRAME_FLAG = 1;
+	static const size_t STREAM_HEADER_SIZE = 5;
+	static const size_t FRAME_HEADER_SIZE = 1 + 8 + 2 + 2 + 4;
+
+	struct Frame {
+		uint64_t time; //microseconds since the stream started
+		int width;
+		int height;
+		bool keyframe;
+	};
+
+	//turns successive frames into deltas, remembering the last frame it encoded
+	class Encoder {
+	private:
+		std::vector<Video::Cell> previous;
+		int width;
+		int height;
+		unsigned long frameCount;
+		unsigned long keyframeInterval;
+
+	public:
+		//unchanged gaps shorter than this are folded into the surrounding span, since a new span costs about as much
+		static const int MERGE_GAP = 4;
+
+		//a keyframe goes out every keyframeInterval frames, or never if it is zero. a change in size always forces one
+		inline Encoder(unsigned long keyframeInterval):
+		width(0), height(0), frameCount(0), keyframeInterval(keyframeInterval) {
+		}
+
+		//appends the frame to out, as a delta against the last frame or as a keyframe. returns true if it was a keyframe
+		bool Encode(const Video::Cell* cells, int width, int height, uint64_t time, std::vector<unsigned char>& out);
+
+		inline unsigned long GetFrameCount(void) const {
+			return frameCount;
+		}
+	};
+
+	//appends a frame as a keyframe without involving any encoder's history
+	extern void EncodeKeyframe(const Video::Cell* cells, int width, int height, uint64_t time, std::vector<unsigned char>& out);
+
+	extern void WriteStreamHeader(std::vector<unsigned char>& out);
+	//throws if the header isn't a stream header of this version. in must hold STREAM_HEADER_SIZE bytes
+	extern void CheckStreamHeader(const unsigned char* in);
+
+	//reads a frame header. in must hold FRAME_HEADER_SIZE bytes
+	extern void ReadFrameHeader(const unsigned char* in, Frame& frame, uint32_t& payloadSize);
+
+	//applies a frame's payload to cells, which must hold the frame before it unless this one is a keyframe
+	//throws if the payload is corrupt
+	extern void Decode(const Frame& frame, const unsigned char* payload, size_t size, std::vector<Video::Cell>& cells);
+};
+
+#endif
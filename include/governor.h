@@ -0,0 +1,82 @@
+//Nick Sells, 2024
+
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+#include <chrono>
+#include <cstddef>
+
+//trades quality for speed to keep frames within a time budget
+//each frame is timed stage by stage, and the total is smoothed. when it stays over budget for a while the governor steps
+//down a ladder of cheaper settings, and when it stays well under budget for longer it steps back up. the gap between the
+//two thresholds and the pause after each step stop it from flip-flopping between two settings
+class Governor {
+public:
+	enum Stage {
+		Simulate,
+		Render, //culling, transforming and recording
+		Rasterize, //executing the recorded commands
+		Present,
+		STAGE_COUNT
+	};
+
+	//what the current step of the ladder allows
+	struct Settings {
+		float lodBias; //multiplies the triangles a LOD may spend per cell, so below one picks coarser LODs
+		bool hiddenLines; //whether hidden-line mode may be on, if it was asked for
+		int overlayDetail;
+	};
+
+	//how much the smoothed frame time follows each new frame
+	static constexpr double SMOOTHING = 0.2;
+	//step down after this many frames over budget in a row
+	static const int DEGRADE_FRAMES = 5;
+	//step up after this many frames under RECOVER_FRACTION of the budget in a row
+	static const int RECOVER_FRAMES = 30;
+	static constexpr double RECOVER_FRACTION = 0.6;
+	//frames to wait after a step before judging again, since the first frames after a change aren't representative
+	static const int SETTLE_FRAMES = 10;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	double budget; //milliseconds
+	Clock::time_point frameStart;
+	Clock::time_point lastMark;
+	double stageTimes[STAGE_COUNT];
+	double smoothedStageTimes[STAGE_COUNT];
+	double frameTime;
+	double smoothedFrameTime;
+	size_t step;
+	int overFrames;
+	int underFrames;
+	int settleFrames;
+
+public:
+	//takes the budget for the work of each frame in milliseconds, not counting time spent waiting for input
+	Governor(double budget);
+
+	//starts timing a frame
+	void BeginFrame(void);
+	//charges the time since the previous mark (or BeginFrame) to a stage
+	void Mark(Stage stage);
+	//totals the frame and moves along the ladder if the recent frames call for it
+	void EndFrame(void);
+
+	const Settings& GetSettings(void) const;
+
+	//the current step of the ladder, where zero is full quality, and how many steps there are
+	inline size_t GetStep(void) const { return step; }
+	static size_t GetStepCount(void);
+
+	inline double GetBudget(void) const { return budget; }
+	inline double GetFrameTime(void) const { return frameTime; }
+	inline double GetSmoothedFrameTime(void) const { return smoothedFrameTime; }
+	inline double GetStageTime(Stage stage) const { return smoothedStageTimes[stage]; }
+	static const char* GetStageName(Stage stage);
+
+	//how long is left of the budget this frame, in milliseconds, for waiting on input without slowing the frame rate
+	int GetIdleTime(void) const;
+};
+
+#endif
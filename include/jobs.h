@@ -0,0 +1,47 @@
+//Nick Sells, 2024
+
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <cstddef>
+
+//a fixed pool of worker threads for data-parallel loops
+//the threads are started once by Init and sleep between jobs, so a ParallelFor costs a wakeup rather than a thread spawn
+namespace Jobs {
+
+	//a job receives a half-open range of the loop and the index of the thread running it, from 0 to GetThreadCount() - 1
+	//jobs only run while ParallelFor is on the stack, so this just borrows the callable instead of copying it the way
+	//std::function would, which keeps lambdas with more than a couple of captures from going to the heap every loop
+	class RangeFunc {
+	private:
+		const void* callable;
+		void (*invoke)(const void* callable, size_t begin, size_t end, unsigned int thread);
+
+	public:
+		template <typename Func>
+		inline RangeFunc(const Func& func):
+		callable(&func), invoke([](const void* callable, size_t begin, size_t end, unsigned int thread) {
+			(*(const Func*) callable)(begin, end, thread);
+		}) {
+		}
+
+		inline void operator()(size_t begin, size_t end, unsigned int thread) const {
+			invoke(callable, begin, end, thread);
+		}
+	};
+
+	//starts the workers. zero means one per hardware thread. the calling thread counts as one of them, as thread 0
+	extern void Init(unsigned int threads = 0);
+	extern void Deinit(void);
+
+	//the number of threads that may run a job, including the caller. 1 when the pool isn't running
+	extern unsigned int GetThreadCount(void);
+
+	//splits [0, count) into chunks of at least grain items and runs them across the pool, returning when all are done
+	//the calling thread works too. runs everything inline when the pool isn't running or the loop is too small to split
+	//NOTE: only the thread that called Init, or a job, may call this. a call from inside a job runs inline with that
+	//job's thread index, so data kept per thread stays private to it
+	extern void ParallelFor(size_t count, size_t grain, const RangeFunc& func);
+};
+
+#endif
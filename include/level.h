@@ -3,26 +3,115 @@
 #ifndef LEVEL_H
 #define LEVEL_H
 
-#include "camera.h"
-#include "gameobject.h"
+#include <string>
+#include <vector>
+
+#include <glm/matrix.hpp>
+
+#include "model.h"
 
 //TODO: BVH!!!!
 
+//refers to a model owned by a level
+typedef unsigned int ModelHandle;
+
+//refers to an object in a level. the generation makes handles to removed objects detectably stale,
+//even after their slot has been reused by a newer object
+struct ObjectHandle {
+	unsigned int slot;
+	unsigned int generation;
+};
+
+//stores a level's objects as parallel arrays rather than an array of objects, so that per-frame passes only stream
+//through the data they actually touch. objects are kept densely packed: removal moves the last object into the hole
 class Level {
 
-public:
+private:
+	struct Slot {
+		unsigned int dense;
+		unsigned int generation;
+	};
 
-	std::vector<GameObject> objects;
+	std::vector<Model> models;
 
-	Level(void);
+	//dense, one entry per live object, all in the same order
+	std::vector<glm::mat4> transforms;
+	std::vector<glm::vec4> spheres; //world-space bounding spheres, center in xyz and radius in w
+	std::vector<ModelHandle> meshes;
+	std::vector<unsigned long> versions;
+	std::vector<unsigned char> occluders; //nonzero for objects big and solid enough to hide others
+	std::vector<unsigned int> owners; //the slot each dense entry belongs to
 
-	Level(const std::string& path) {
-		assert(!"not implemented");	
+	//sparse, indexed by handle
+	std::vector<Slot> slots;
+	std::vector<unsigned int> freeSlots;
+
+	size_t occluderCount;
+
+	void UpdateBounds(unsigned int dense);
+
+	//hands out versions that are unique across all levels, like Transform does, so a cache keyed on an object's slot
+	//and version can't be fooled by a new level built where an old one used to be
+	static inline unsigned long NextVersion(void) {
+		static unsigned long counter = 0;
+		return ++counter;
 	}
 
-	Level(const std::vector<GameObject>& objects):
-		objects(objects) {
+public:
+	inline Level(void):
+	occluderCount(0) {
 	}
+
+	//one line of a .map file, placing a model in the level
+	struct MapEntry {
+		std::string model; //path of the model's file
+		glm::vec3 position;
+		glm::vec3 rotation; //degrees about x, then y, then z
+		glm::vec3 scale;
+
+		glm::mat4 GetTransform(void) const;
+	};
+
+	//reads a .map file, which places one model per line as: "path/to/model.obj" {x,y,z} {rx,ry,rz} {sx,sy,sz}
+	//blank lines and lines starting with # are skipped. throws if the file can't be read or a line is malformed
+	static std::vector<MapEntry> ReadMap(const std::string& path);
+
+	//takes ownership of a model and returns a handle objects can refer to it by
+	ModelHandle AddModel(Model&& model);
+
+	//swaps a model for another, eg. once it has finished loading or its file has changed
+	//every object using it gets new bounds and a new version
+	void ReplaceModel(ModelHandle handle, Model&& model);
+
+	inline const Model& GetModel(ModelHandle handle) const {
+		return models[handle];
+	}
+
+	ObjectHandle AddObject(const glm::mat4& transform, ModelHandle mesh);
+	//removes an object in constant time. handles to other objects stay valid
+	void RemoveObject(ObjectHandle handle);
+	bool IsValid(ObjectHandle handle) const;
+
+	//marks an object as an occluder, so cameras draw it into their occlusion buffer before testing everything else
+	void SetOccluder(ObjectHandle handle, bool occluder);
+
+	const glm::mat4& GetTransform(ObjectHandle handle) const;
+	void SetTransform(ObjectHandle handle, const glm::mat4& transform);
+	//sets many transforms at once, spread across the job pool. every object gets the same new version
+	//NOTE: a handle may appear only once per call
+	void SetTransforms(const ObjectHandle* handles, const glm::mat4* newTransforms, size_t count);
+
+	//the dense arrays, for passes that run over every object
+	inline size_t GetObjectCount(void) const { return transforms.size(); }
+	inline const std::vector<glm::mat4>& GetTransforms(void) const { return transforms; }
+	inline const std::vector<glm::vec4>& GetSpheres(void) const { return spheres; }
+	inline const std::vector<ModelHandle>& GetMeshes(void) const { return meshes; }
+	//bumped whenever an object's transform or model is set
+	inline const std::vector<unsigned long>& GetVersions(void) const { return versions; }
+	inline const std::vector<unsigned char>& GetOccluders(void) const { return occluders; }
+	//the slot each dense entry belongs to. unlike the dense index, it stays with an object when removals move it
+	inline const std::vector<unsigned int>& GetOwners(void) const { return owners; }
+	inline size_t GetOccluderCount(void) const { return occluderCount; }
 };
 
 #endif
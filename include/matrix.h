@@ -0,0 +1,537 @@
+//Nick Sells, 2023
+
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <initializer_list>
+#include <type_traits>
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "vector.h"
+
+#if defined(__SSE__) || defined(_M_X64)
+	#include <immintrin.h>
+	#define MATRIX_SSE 1
+#endif
+#if defined(__AVX__)
+	#define MATRIX_AVX 1
+#endif
+
+//a matrix with N rows and N columns, stored row by row
+//everything is constexpr. outside of constant evaluation, 4x4 products against vectors and other 4x4s
+//take SSE paths (and AVX for batches) when the compiler targets them
+template <size_t Rows, size_t Cols>
+class Matrix {
+private:
+	float elems[Rows][Cols];
+
+	template <size_t, size_t>
+	friend class Matrix;
+
+#ifdef MATRIX_SSE
+	//loads the four rows of a 4x4 and transposes them in registers, giving its columns
+	static inline void LoadColumns(const Matrix<4,4>& mat, __m128& c0, __m128& c1, __m128& c2, __m128& c3) noexcept {
+		c0 = _mm_loadu_ps(mat.elems[0]);
+		c1 = _mm_loadu_ps(mat.elems[1]);
+		c2 = _mm_loadu_ps(mat.elems[2]);
+		c3 = _mm_loadu_ps(mat.elems[3]);
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+	}
+
+	//a linear combination of the columns, weighted by the components of v
+	static inline __m128 Combine(__m128 c0, __m128 c1, __m128 c2, __m128 c3, __m128 v) noexcept {
+		__m128 x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0,0,0,0));
+		__m128 y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1,1,1,1));
+		__m128 z = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2,2,2,2));
+		__m128 w = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3,3,3,3));
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, x), _mm_mul_ps(c1, y)), _mm_add_ps(_mm_mul_ps(c2, z), _mm_mul_ps(c3, w)));
+	}
+
+	//the same, but for a point with an implied w of one, so the last column is added rather than scaled
+	static inline __m128 CombineAffine(__m128 c0, __m128 c1, __m128 c2, __m128 c3, __m128 v) noexcept {
+		__m128 x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0,0,0,0));
+		__m128 y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1,1,1,1));
+		__m128 z = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2,2,2,2));
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, x), _mm_mul_ps(c1, y)), _mm_add_ps(_mm_mul_ps(c2, z), c3));
+	}
+#endif
+
+#ifdef MATRIX_AVX
+	//puts the same 4-wide value in both halves of an AVX register
+	static inline __m256 Duplicate(__m128 v) noexcept {
+		return _mm256_insertf128_ps(_mm256_castps128_ps256(v), v, 1);
+	}
+#endif
+
+	//transforms a batch of vectors without any SIMD. also used for constant evaluation
+	static inline constexpr void TransformScalar(const Matrix<4,4>& mat, const Vector<4>* in, Vector<4>* out, size_t count, bool affine) noexcept {
+		for(size_t i = 0; i < count; i++) {
+			Vector<4> v = in[i];
+			Vector<4> result;
+			for(size_t row = 0; row < 4; row++) {
+				float sum = mat.elems[row][0] * v.elems[0] + mat.elems[row][1] * v.elems[1] + mat.elems[row][2] * v.elems[2];
+				result.elems[row] = sum + mat.elems[row][3] * (affine ? 1.0f : v.elems[3]);
+			}
+			out[i] = result;
+		}
+	}
+
+	static inline void TransformBatch(const Matrix<4,4>& mat, const Vector<4>* in, Vector<4>* out, size_t count, bool affine) noexcept {
+#ifdef MATRIX_SSE
+		__m128 c0, c1, c2, c3;
+		LoadColumns(mat, c0, c1, c2, c3);
+		size_t i = 0;
+	#ifdef MATRIX_AVX
+		//two vectors per iteration, one in each 128-bit lane
+		__m256 wc0 = Duplicate(c0), wc1 = Duplicate(c1), wc2 = Duplicate(c2), wc3 = Duplicate(c3);
+		for(; i + 2 <= count; i += 2) {
+			__m256 v = _mm256_loadu_ps(in[i].elems);
+			__m256 x = _mm256_permute_ps(v, _MM_SHUFFLE(0,0,0,0));
+			__m256 y = _mm256_permute_ps(v, _MM_SHUFFLE(1,1,1,1));
+			__m256 z = _mm256_permute_ps(v, _MM_SHUFFLE(2,2,2,2));
+			__m256 w = affine ? _mm256_set1_ps(1.0f) : _mm256_permute_ps(v, _MM_SHUFFLE(3,3,3,3));
+			__m256 result = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(wc0, x), _mm256_mul_ps(wc1, y)), _mm256_add_ps(_mm256_mul_ps(wc2, z), _mm256_mul_ps(wc3, w)));
+			_mm256_storeu_ps(out[i].elems, result);
+		}
+	#endif
+		if(affine) {
+			for(; i < count; i++)
+				_mm_storeu_ps(out[i].elems, CombineAffine(c0, c1, c2, c3, _mm_loadu_ps(in[i].elems)));
+		}
+		else {
+			for(; i < count; i++)
+				_mm_storeu_ps(out[i].elems, Combine(c0, c1, c2, c3, _mm_loadu_ps(in[i].elems)));
+		}
+#else
+		TransformScalar(mat, in, out, count, affine);
+#endif
+	}
+
+public:
+	//default constructor
+	inline constexpr Matrix(void) noexcept {
+		for(size_t row = 0; row < Rows; row++)
+			for(size_t col = 0; col < Cols; col++)
+				this->elems[row][col] = 0.0f;
+	}
+
+	//element-wise constructor
+	template <typename... Args>
+	inline constexpr Matrix(const Args&... args) noexcept {
+		static_assert(sizeof...(args) == Rows * Cols, "incorrect number of elements supplied");
+		const float values[] = {static_cast<float>(args)...};
+		for(size_t row = 0; row < Rows; row++)
+			for(size_t col = 0; col < Cols; col++)
+				this->elems[row][col] = values[row * Cols + col];
+	}
+
+	//typical copy constructor. defaulted so that matrices stay trivially copyable
+	inline constexpr Matrix(const Matrix& other) noexcept = default;
+	inline constexpr Matrix& operator=(const Matrix& other) noexcept = default;
+
+	//converts from a glm matrix of the same shape. glm stores column by column, so this transposes the storage
+	inline constexpr explicit Matrix(const glm::mat<Cols,Rows,float>& other) noexcept {
+		for(size_t row = 0; row < Rows; row++)
+			for(size_t col = 0; col < Cols; col++)
+				this->elems[row][col] = other[col][row];
+	}
+
+	//converts to a glm matrix of the same shape
+	inline constexpr explicit operator glm::mat<Cols,Rows,float>() const noexcept {
+		glm::mat<Cols,Rows,float> result;
+		for(size_t row = 0; row < Rows; row++)
+			for(size_t col = 0; col < Cols; col++)
+				result[col][row] = this->elems[row][col];
+		return result;
+	}
+
+	//used as a container for the pointer returned from the matrix [] operator
+	//allows us to do bounds checking on the 2nd dimension index
+	struct RowProxy {
+	private:
+		float* rowData;
+
+	public:
+		//constructs a new row proxy with the given pointer
+		inline constexpr RowProxy(float* data) noexcept : rowData(data) {}
+
+		//allows access to the elements pointed to by this row proxy
+		inline constexpr float& operator[](size_t col) noexcept {
+			assert(col < Cols);
+			assert(rowData != nullptr);
+			return rowData[col];
+		}
+
+		//writes the contents of an initializer list to the row pointed to by this proxy
+		//TODO: figure out how to rewrite using variadic templates bc initializer lists
+		//disqualify this method from being constexpr-able and i hate them
+		inline RowProxy& operator=(std::initializer_list<float> args) noexcept {
+			assert(args.size() == Cols);
+			assert(rowData != nullptr);
+			size_t col = 0;
+			for(auto elem : args)
+				this->rowData[col++] = elem;
+			return (*this);
+		}
+	};
+
+	//returns a RowProxy object of the row-th row of this matrix, which can then be indexed for the elements
+	inline constexpr RowProxy operator[](size_t row) {
+		assert(row < Rows);
+		return RowProxy(this->elems[row]);
+	}
+
+	//reads a single element. usable on const matrices, unlike the row proxy
+	inline constexpr float operator()(size_t row, size_t col) const noexcept {
+		assert(row < Rows && col < Cols);
+		return this->elems[row][col];
+	}
+
+	//multiplies this matrix by another
+	//rows*cols x otherRows*otherCols = rows*otherCols
+	//otherRows = cols
+	//NOTE: will not compile if the matrices are incompatible for multiplication
+	template<size_t OtherCols>
+	inline constexpr Matrix<Rows,OtherCols> operator*(const Matrix<Cols,OtherCols>& other) const noexcept {
+		Matrix<Rows,OtherCols> result;
+#ifdef MATRIX_SSE
+		if constexpr (Rows == 4 && Cols == 4 && OtherCols == 4) {
+			if (!std::is_constant_evaluated()) {
+				//each row of the result is a combination of the other matrix's rows, weighted by this row
+				__m128 b0 = _mm_loadu_ps(other.elems[0]);
+				__m128 b1 = _mm_loadu_ps(other.elems[1]);
+				__m128 b2 = _mm_loadu_ps(other.elems[2]);
+				__m128 b3 = _mm_loadu_ps(other.elems[3]);
+				for(size_t row = 0; row < 4; row++)
+					_mm_storeu_ps(result.elems[row], Combine(b0, b1, b2, b3, _mm_loadu_ps(this->elems[row])));
+				return result;
+			}
+		}
+#endif
+		for(size_t row = 0; row < Rows; row++)
+			for(size_t otherCol = 0; otherCol < OtherCols; otherCol++)
+				for(size_t otherRow = 0; otherRow < Cols; otherRow++)
+					result.elems[row][otherCol] += this->elems[row][otherRow] * other.elems[otherRow][otherCol];
+		return result;
+	}
+
+	//multiplies this matrix by a column vector
+	inline constexpr Vector<Rows> operator*(const Vector<Cols>& vec) const noexcept {
+#ifdef MATRIX_SSE
+		if constexpr (Rows == 4 && Cols == 4) {
+			if (!std::is_constant_evaluated()) {
+				//multiply every row by the vector, then transpose the products so the sums line up in one register
+				__m128 v = _mm_loadu_ps(vec.elems);
+				__m128 r0 = _mm_mul_ps(_mm_loadu_ps(this->elems[0]), v);
+				__m128 r1 = _mm_mul_ps(_mm_loadu_ps(this->elems[1]), v);
+				__m128 r2 = _mm_mul_ps(_mm_loadu_ps(this->elems[2]), v);
+				__m128 r3 = _mm_mul_ps(_mm_loadu_ps(this->elems[3]), v);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				Vector<4> result;
+				_mm_storeu_ps(result.elems, _mm_add_ps(_mm_add_ps(r0, r1), _mm_add_ps(r2, r3)));
+				return result;
+			}
+		}
+#endif
+		//NOTE: this is just a special case of matrix multiplication. we treat the vector as an Nx1 matrix
+		Vector<Rows> result;
+		for(size_t row = 0; row < Rows; row++)
+			for(size_t col = 0; col < Cols; col++)
+				result.elems[row] += this->elems[row][col] * vec.elems[col];
+		return result;
+	}
+
+	//multiplies each element of this matrix by a scalar
+	inline constexpr Matrix operator*(float scalar) const noexcept {
+		Matrix result;
+		for(size_t row = 0; row < Rows; row++)
+			for(size_t col = 0; col < Cols; col++)
+				result.elems[row][col] = this->elems[row][col] * scalar;
+		return result;
+	}
+
+	//divides each element of this matrix by a scalar
+	inline constexpr Matrix operator/(float scalar) const noexcept {
+		assert(scalar != 0.0f); //cannot divide by zero
+		Matrix result;
+		for(size_t row = 0; row < Rows; row++)
+			for(size_t col = 0; col < Cols; col++)
+				result.elems[row][col] = this->elems[row][col] / scalar;
+		return result;
+	}
+
+	//checks if two matrices are equal
+	inline constexpr bool operator==(const Matrix& other) const noexcept {
+		for(size_t row = 0; row < Rows; row++)
+			for(size_t col = 0; col < Cols; col++)
+				if(this->elems[row][col] != other.elems[row][col])
+					return false;
+		return true;
+	}
+
+	//appends a matrix to an output stream
+	inline friend std::ostream& operator<<(std::ostream& stream, const Matrix& matrix) {
+
+		const int precision = 15;
+		const int chars = 19;
+
+		for(size_t row = 0; row < Rows; row++) {
+			stream << "[ ";
+			for(size_t col = 0; col < Cols; col++)
+				stream << std::fixed << std::setprecision(precision) << std::setw(chars) << matrix.elems[row][col] << " ";
+			stream << "]\n";
+		}
+
+		return stream;
+	}
+
+	//swaps rows and columns
+	inline constexpr Matrix<Cols,Rows> Transpose(void) const noexcept {
+		Matrix<Cols,Rows> result;
+		for(size_t row = 0; row < Rows; row++)
+			for(size_t col = 0; col < Cols; col++)
+				result.elems[col][row] = this->elems[row][col];
+		return result;
+	}
+
+	//true if the bottom row is 0 0 0 1, ie. the matrix only rotates, scales, shears and translates
+	inline constexpr bool IsAffine(void) const noexcept {
+		static_assert(Rows == 4 && Cols == 4, "affine matrices are 4x4");
+		return this->elems[3][0] == 0.0f && this->elems[3][1] == 0.0f && this->elems[3][2] == 0.0f && this->elems[3][3] == 1.0f;
+	}
+
+	//transforms a point by an affine matrix. skips the bottom row entirely, so there is no w to compute or divide by
+	inline constexpr Vector<3> TransformPoint(const Vector<3>& point) const noexcept {
+		static_assert(Rows == 4 && Cols == 4, "points are transformed by 4x4 matrices");
+		assert(IsAffine());
+		Vector<3> result;
+		for(size_t row = 0; row < 3; row++)
+			result.elems[row] = this->elems[row][0] * point.elems[0] + this->elems[row][1] * point.elems[1] + this->elems[row][2] * point.elems[2] + this->elems[row][3];
+		return result;
+	}
+
+	//transforms a direction by an affine matrix, ignoring the translation
+	inline constexpr Vector<3> TransformDirection(const Vector<3>& dir) const noexcept {
+		static_assert(Rows == 4 && Cols == 4, "directions are transformed by 4x4 matrices");
+		Vector<3> result;
+		for(size_t row = 0; row < 3; row++)
+			result.elems[row] = this->elems[row][0] * dir.elems[0] + this->elems[row][1] * dir.elems[1] + this->elems[row][2] * dir.elems[2];
+		return result;
+	}
+
+	//multiplies count vectors by a 4x4 matrix. in and out may be the same array
+	//the columns are set up once for the whole batch, and with AVX two vectors go through per instruction
+	static inline constexpr void Transform(const Matrix<4,4>& mat, const Vector<4>* in, Vector<4>* out, size_t count) noexcept {
+		if (std::is_constant_evaluated())
+			TransformScalar(mat, in, out, count, false);
+		else
+			TransformBatch(mat, in, out, count, false);
+	}
+
+	//like Transform, but for an affine matrix and points. every input w is taken to be one and the outputs' w will be one
+	static inline constexpr void TransformAffine(const Matrix<4,4>& mat, const Vector<4>* in, Vector<4>* out, size_t count) noexcept {
+		assert(mat.IsAffine());
+		if (std::is_constant_evaluated())
+			TransformScalar(mat, in, out, count, true);
+		else
+			TransformBatch(mat, in, out, count, true);
+	}
+
+	//multiplies two affine matrices. the bottom rows are known, so they are neither read nor multiplied
+	inline constexpr Matrix<4,4> AffineMultiply(const Matrix<4,4>& other) const noexcept {
+		static_assert(Rows == 4 && Cols == 4, "affine matrices are 4x4");
+		assert(IsAffine() && other.IsAffine());
+		Matrix<4,4> result;
+		for(size_t row = 0; row < 3; row++) {
+			for(size_t col = 0; col < 4; col++) {
+				float sum = this->elems[row][0] * other.elems[0][col] + this->elems[row][1] * other.elems[1][col] + this->elems[row][2] * other.elems[2][col];
+				result.elems[row][col] = (col == 3) ? sum + this->elems[row][3] : sum;
+			}
+		}
+		result.elems[3][3] = 1.0f;
+		return result;
+	}
+
+	//inverts an affine matrix by inverting the upper 3x3 and counter-transforming the translation
+	//much cheaper than a general inverse, and unlike Util::RigidInverse it allows scale and shear
+	inline constexpr Matrix<4,4> AffineInverse(void) const noexcept {
+		static_assert(Rows == 4 && Cols == 4, "affine matrices are 4x4");
+		assert(IsAffine());
+		const auto& m = this->elems;
+
+		//cofactors of the upper 3x3, laid out already transposed
+		Matrix<4,4> result;
+		result.elems[0][0] = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+		result.elems[0][1] = m[0][2] * m[2][1] - m[0][1] * m[2][2];
+		result.elems[0][2] = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+		result.elems[1][0] = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+		result.elems[1][1] = m[0][0] * m[2][2] - m[0][2] * m[2][0];
+		result.elems[1][2] = m[0][2] * m[1][0] - m[0][0] * m[1][2];
+		result.elems[2][0] = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+		result.elems[2][1] = m[0][1] * m[2][0] - m[0][0] * m[2][1];
+		result.elems[2][2] = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+
+		float det = m[0][0] * result.elems[0][0] + m[0][1] * result.elems[1][0] + m[0][2] * result.elems[2][0];
+		assert(det != 0.0f); //singular matrices have no inverse
+		float invDet = 1.0f / det;
+		for(size_t row = 0; row < 3; row++)
+			for(size_t col = 0; col < 3; col++)
+				result.elems[row][col] *= invDet;
+
+		for(size_t row = 0; row < 3; row++)
+			result.elems[row][3] = -(result.elems[row][0] * m[0][3] + result.elems[row][1] * m[1][3] + result.elems[row][2] * m[2][3]);
+		result.elems[3][3] = 1.0f;
+		return result;
+	}
+
+	//inverts any invertible 4x4 matrix by cofactor expansion over 2x2 sub-determinants
+	inline constexpr Matrix<4,4> Inverse(void) const noexcept {
+		static_assert(Rows == 4 && Cols == 4, "only 4x4 inverses are implemented");
+		const auto& m = this->elems;
+
+		//determinants of the 2x2s in the top two rows (s) and the bottom two (c)
+		float s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+		float s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+		float s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+		float s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+		float s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+		float s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+		float c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+		float c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+		float c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+		float c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+		float c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+		float c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+		float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		assert(det != 0.0f); //singular matrices have no inverse
+		float invDet = 1.0f / det;
+
+		Matrix<4,4> result;
+		result.elems[0][0] = ( m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * invDet;
+		result.elems[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * invDet;
+		result.elems[0][2] = ( m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * invDet;
+		result.elems[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * invDet;
+		result.elems[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * invDet;
+		result.elems[1][1] = ( m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * invDet;
+		result.elems[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * invDet;
+		result.elems[1][3] = ( m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * invDet;
+		result.elems[2][0] = ( m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * invDet;
+		result.elems[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * invDet;
+		result.elems[2][2] = ( m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * invDet;
+		result.elems[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * invDet;
+		result.elems[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * invDet;
+		result.elems[3][1] = ( m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * invDet;
+		result.elems[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * invDet;
+		result.elems[3][3] = ( m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * invDet;
+		return result;
+	}
+
+	//creates an NxN identity matrix
+	inline static constexpr Matrix Identity(void) noexcept {
+		static_assert(Rows == Cols, "identity is defined only for square matrices");
+		Matrix<Rows,Rows> result;
+		for(size_t i = 0; i < Rows; i++)
+			result.elems[i][i] = 1.0f;
+		return result;
+	}
+
+	//creates a 3D translation matrix
+	inline static constexpr Matrix<4,4> Translation(const Vector<3>& delta) noexcept {
+		auto result = Matrix<4,4>::Identity();
+		for(size_t i = 0; i < 3; i++)
+			result.elems[i][3] = delta.elems[i];
+		return result;
+	}
+
+	//creates a 3D scale matrix
+	inline static constexpr Matrix<4,4> Scale(const Vector<3>& factors) noexcept {
+		auto result = Matrix<4,4>::Identity();
+		for(size_t i = 0; i < 3; i++)
+			result.elems[i][i] = factors.elems[i];
+		return result;
+	}
+
+	//creates a matrix that rotates theta radians about the origin in the YZ-plane
+	inline static Matrix<4,4> RotationX(float pitch) noexcept {
+		auto result = Matrix<4,4>::Identity();
+		float c = cos(pitch);
+		float s = sin(pitch);
+		result.elems[1][1] = result.elems[2][2] = c;
+		result.elems[1][2] = -s;
+		result.elems[2][1] = s;
+		return result;
+	}
+
+	//creates a matrix that rotates theta radians about the origin in the XZ-plane
+	inline static Matrix<4,4> RotationY(float yaw) noexcept {
+		auto result = Matrix<4,4>::Identity();
+		float c = cos(yaw);
+		float s = sin(yaw);
+		result.elems[0][0] = result.elems[2][2] = c;
+		result.elems[0][2] = s;
+		result.elems[2][0] = -s;
+		return result;
+	}
+
+	//creates a matrix that rotates theta radians about the origin in the XY-plane
+	inline static Matrix<4,4> RotationZ(float roll) noexcept {
+		auto result = Matrix<4,4>::Identity();
+		float c = cos(roll);
+		float s = sin(roll);
+		result[0][0] = result[1][1] = c;
+		result[0][1] = -s;
+		result[1][0] = s;
+		return result;
+	}
+
+	//creates a matrix that combines X, Y, and Z axis rotation using euler angles
+	//pitch is applied first and roll last, ie. RotationZ(roll) * RotationY(yaw) * RotationX(pitch)
+	inline static Matrix<4,4> Rotation(float pitch, float yaw, float roll) noexcept {
+		auto result = Matrix<4,4>::Identity();
+		float cx = cos(pitch);
+		float sx = sin(pitch);
+		float cy = cos(yaw);
+		float sy = sin(yaw);
+		float cz = cos(roll);
+		float sz = sin(roll);
+		result[0][0] = cy*cz;
+		result[0][1] = sx*sy*cz-cx*sz;
+		result[0][2] = cx*sy*cz+sx*sz;
+		result[1][0] = cy*sz;
+		result[1][1] = sx*sy*sz+cx*cz;
+		result[1][2] = cx*sy*sz-sx*cz;
+		result[2][0] = -sy;
+		result[2][1] = sx*cy;
+		result[2][2] = cx*cy;
+		return result;
+	}
+
+	//uses Rodrigues' rotation formula to create an angle-axis rotation matrix
+	inline static Matrix<4,4> Rotation(const Vector<3>& axis, float theta) {
+		auto result = Matrix<4,4>::Identity();
+
+		float c = cos(theta);
+		float s = sin(theta);
+		float oneMinusC = 1-c;
+
+		result[0][0] = oneMinusC * axis[0] * axis[0] + c;
+		result[0][1] = oneMinusC * axis[0] * axis[1] - axis[2] * s;
+		result[0][2] = oneMinusC * axis[0] * axis[2] + axis[1] * s;
+		result[1][0] = oneMinusC * axis[0] * axis[1] + axis[2] * s;
+		result[1][1] = oneMinusC * axis[1] * axis[1] + c;
+		result[1][2] = oneMinusC * axis[1] * axis[2] - axis[0] * s;
+		result[2][0] = oneMinusC * axis[0] * axis[2] - axis[1] * s;
+		result[2][1] = oneMinusC * axis[1] * axis[2] + axis[0] * s;
+		result[2][2] = oneMinusC * axis[2] * axis[2] + c;
+
+		return result;
+	}
+};
+
+typedef Matrix<3,3> Matrix3;
+typedef Matrix<4,4> Matrix4;
+
+#endif
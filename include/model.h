@@ -9,26 +9,142 @@
 #include <vector>
 
 #include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/common.hpp>
 
 #include "util.h"
 
+//a vertex position stored as three 16-bit fractions of the owning model's bounds
+struct QuantizedVert {
+	unsigned short x, y, z;
+};
+
 struct Model {
 
 	enum class Primitive : unsigned char {
 		Points = 0,
 		Lines = 1,
 		Triangles = 2,
-		//Quads = 3 //TODO: add support for quads, but it will necessitate extra checks to make sure verts are coplanar
+		//NOTE: quads are only ever drawn as outlines, so a non-coplanar quad just looks bent rather than breaking anything
+		Quads = 3,
+		//the strip and loop primitives share verts between neighbors and may be split by RESTART_INDEX
+		LineStrip = 4,
+		LineLoop = 5,
+		TriangleStrip = 6
 	};
 
+	//an index with this value ends the current strip or loop and starts a new one
+	static constexpr unsigned short RESTART_INDEX = 0xFFFF;
+
 	std::vector<glm::vec3> verts;
 	std::vector<unsigned short> indices;
 	Primitive renderingPrimitive;
 
+	//compressed copy of verts, used instead of them once the model has been quantized
+	std::vector<QuantizedVert> quantizedVerts;
+
+	//axis-aligned bounds of the verts in model space
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+
+	//progressively coarser versions of this model, finest first. empty if the model has no LODs
+	std::vector<Model> lods;
+
 	inline Model(const std::vector<glm::vec3>& verts, const std::vector<unsigned short>& indices, Primitive renderingPrimitive):
 	verts(verts), indices(indices), renderingPrimitive(renderingPrimitive) {
+		UpdateBounds();
+	}
+
+	inline bool IsQuantized(void) const {
+		return !quantizedVerts.empty();
 	}
 
+	inline size_t GetVertexCount(void) const {
+		return IsQuantized() ? quantizedVerts.size() : verts.size();
+	}
+
+	//maps a quantized vertex back into model space. folding this into the object matrix makes dequantization free
+	inline glm::mat4 GetDequantization(void) const {
+		glm::mat4 result(1.0f);
+		glm::vec3 extent = boundsMax - boundsMin;
+		for (int i = 0; i < 3; i++)
+			result[i][i] = extent[i] / 65535.0f;
+		result[3] = glm::vec4(boundsMin, 1.0f);
+		return result;
+	}
+
+	//returns a vertex in model space whether or not the model is quantized
+	//meant for occasional access; hot loops should fold GetDequantization into their matrix instead
+	inline glm::vec3 GetVertex(size_t i) const {
+		if (!IsQuantized())
+			return verts[i];
+		const QuantizedVert& q = quantizedVerts[i];
+		return boundsMin + (boundsMax - boundsMin) * glm::vec3(q.x, q.y, q.z) / 65535.0f;
+	}
+
+	//replaces the float verts (12 bytes each) with 16-bit positions relative to the bounds (6 bytes each), LODs included
+	//this should run after every other load-time pass, since those all work on the float verts
+	void Quantize(void);
+
+	//recomputes the bounds after the verts were modified, so call it before Quantize
+	//a quantized model's verts are stored relative to its bounds, which can't change without requantizing, so this
+	//does nothing once the model is quantized
+	inline void UpdateBounds(void) {
+		if (IsQuantized())
+			return;
+		boundsMin = boundsMax = verts.empty() ? glm::vec3(0.0f) : verts[0];
+		for (const auto& v : verts) {
+			boundsMin = glm::min(boundsMin, v);
+			boundsMax = glm::max(boundsMax, v);
+		}
+	}
+
+	inline bool IsStrip(void) const {
+		return renderingPrimitive == Primitive::LineStrip
+			|| renderingPrimitive == Primitive::LineLoop
+			|| renderingPrimitive == Primitive::TriangleStrip;
+	}
+
+	//the number of points, lines, triangles or quads the indices describe
+	inline size_t GetPrimitiveCount(void) const {
+		switch (renderingPrimitive) {
+			case Primitive::Points: return indices.size();
+			case Primitive::Lines: return indices.size() / 2;
+			case Primitive::Triangles: return indices.size() / 3;
+			case Primitive::Quads: return indices.size() / 4;
+			default: break;
+		}
+
+		//strips: each run between restarts of n indices makes n-1 lines, n lines when looped, or n-2 triangles
+		size_t perRun = (renderingPrimitive == Primitive::TriangleStrip) ? 2 : (renderingPrimitive == Primitive::LineStrip) ? 1 : 0;
+		size_t count = 0;
+		size_t run = 0;
+		for (size_t i = 0; i <= indices.size(); i++) {
+			if (i == indices.size() || indices[i] == RESTART_INDEX) {
+				if (run > perRun && run >= 2)
+					count += run - perRun;
+				run = 0;
+			}
+			else run++;
+		}
+		return count;
+	}
+
+	//builds a chain of LODs by repeatedly simplifying this model, each level keeping ratio of the previous one's triangles
+	//does nothing for anything but triangle meshes
+	void BuildLods(size_t maxLevels = 4, float ratio = 0.5f);
+
+	//the wireframe cube and tetrahedron from the demo, also used as benchmark scenes
+	static Model Cube(void);
+	static Model Tetrahedron(void);
+
+	//reads a wavefront .obj file as it is, triangulating polygons as a fan, without any of the load-time passes
+	static Model ReadObj(const std::string& path);
+
+	//loads a wavefront .obj file, reorders it for the cache and builds its LOD chain
+	//quantizing trades at most 1/65535th of the model's extent in precision for half the vertex memory
+	static Model LoadObj(const std::string& path, bool quantize = false);
+
 	//appends a text representation of a models verts and indices to an output stream
 	inline friend std::ostream& operator<<(std::ostream& stream, const Model& model) {
 		
@@ -42,7 +158,10 @@ struct Model {
 		stream << "}\nindices: {";
 		n = model.indices.size();
 		for (size_t i = 0; i < n; i++) {
-			stream << model.indices[i];
+			if (model.indices[i] == RESTART_INDEX)
+				stream << "restart";
+			else
+				stream << model.indices[i];
 			if(i < n - 1)
 				stream << ", ";
 		}
@@ -0,0 +1,52 @@
+//Nick Sells, 2024
+
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include <vector>
+
+#include <glm/matrix.hpp>
+
+#include "model.h"
+
+//a coarse hierarchical depth buffer for culling objects hidden behind large occluders before they reach the vertex stage
+//level 0 is one texel per screen cell and every level above it halves the resolution, keeping the farthest depth of the
+//texels it covers. depths are view-space distances, and everything is rounded towards "not occluded"
+class OcclusionBuffer {
+
+private:
+	struct Level {
+		int width;
+		int height;
+		std::vector<float> depth;
+	};
+
+	std::vector<Level> levels;
+	bool empty;
+
+	void RasterizeTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+
+public:
+	inline OcclusionBuffer(void):
+	empty(true) {
+	}
+
+	//sizes the buffer to the screen and marks every texel as infinitely far away
+	void Clear(int width, int height);
+
+	//draws a solid occluder. only triangles, triangle strips and quads can occlude; anything else is ignored
+	//each triangle is written at the depth of its farthest corner, and triangles crossing the near plane are skipped
+	void AddOccluder(const Model& model, const glm::mat4& PVM, float near);
+
+	//fills in the coarser levels. call after the last AddOccluder and before IsOccluded
+	void BuildHierarchy(void);
+
+	//true if a world-space bounding sphere (center in xyz, radius in w) is certainly behind the occluders drawn so far
+	bool IsOccluded(const glm::vec4& sphere, const glm::mat4& viewProjection, float near) const;
+
+	inline bool IsEmpty(void) const {
+		return empty;
+	}
+};
+
+#endif
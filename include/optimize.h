@@ -0,0 +1,32 @@
+//Nick Sells, 2024
+
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+#include "model.h"
+
+//load-time passes that reorder a model's data for better memory locality in Camera::Render
+//neither pass changes what gets drawn, only the order it is stored in
+namespace Optimize {
+
+	//the cache size the reordering targets. it stands in for how many recently gathered screenVerts stay in L1
+	static const size_t CACHE_SIZE = 16;
+
+	//reorders triangles so that consecutive triangles share verts, using Tipsify (Sander, Nehab & Barczak, 2007)
+	extern void ReorderTriangles(Model& model, size_t cacheSize = CACHE_SIZE);
+
+	//renumbers verts in the order the indices first reference them, so the transform loop and the gathers stream forward
+	extern void ReorderVertices(Model& model);
+
+	//runs both passes, triangles first. points and lines only get the vertex pass
+	extern void ForCache(Model& model);
+
+	//converts indexed line lists to line strips and triangle lists to triangle strips, joined by restart indices
+	//the model is left alone unless the strips come out smaller. run it after the other passes, which expect lists
+	extern void Stripify(Model& model);
+
+	//average cache miss ratio: the simulated FIFO cache misses per primitive. lower is better
+	extern float CacheMissRatio(const Model& model, size_t cacheSize = CACHE_SIZE);
+};
+
+#endif
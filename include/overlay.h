@@ -0,0 +1,103 @@
+//Nick Sells, 2024
+
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/matrix.hpp>
+
+//a retained text layer made of named fields stacked top to bottom
+//each field remembers the raw bytes of the values it was last formatted with and only re-runs snprintf
+//when those change, so a frame where nothing changed costs a memcmp per field plus the composite
+//fields have a detail level, and lowering the overlay's detail hides the fields above it, closing up the gaps.
+//hidden fields aren't formatted at all
+class Overlay {
+
+private:
+	struct Field {
+		std::string name;
+		int rows;
+		int detail;
+		bool formatted;
+		std::vector<unsigned char> lastValue;
+		std::vector<std::string> lines;
+	};
+
+	static const size_t LINE_LEN = 128;
+
+	int originX;
+	int originY;
+	int detail;
+	std::vector<Field> fields;
+	std::unordered_map<std::string, size_t> lookup;
+
+	//returns true and remembers the new value if it differs from the one the field was last formatted with
+	inline bool Changed(Field& field, const void* value, size_t size) {
+		if (field.detail > detail) {
+			field.formatted = false; //so that it gets formatted again as soon as it is shown
+			return false;
+		}
+		if (field.formatted && field.lastValue.size() == size && memcmp(field.lastValue.data(), value, size) == 0)
+			return false;
+		field.lastValue.assign((const unsigned char*) value, (const unsigned char*) value + size);
+		field.formatted = true;
+		return true;
+	}
+
+	template <typename... Args>
+	inline void Format(Field& field, int line, const char* format, const Args&... args) {
+		char buffer[LINE_LEN];
+		snprintf(buffer, LINE_LEN, format, args...);
+		field.lines[line] = buffer;
+	}
+
+public:
+	//the detail of fields that are always shown, and of the ones only worth showing when there is time to spare
+	static const int MIN_DETAIL = 0;
+	static const int MAX_DETAIL = 2;
+
+	inline Overlay(int originX = 0, int originY = 0):
+	originX(originX), originY(originY), detail(MAX_DETAIL) {
+	}
+
+	//adds a field below the previous one and returns its handle. the name must be unique
+	//the field is shown while the overlay's detail is at least the field's
+	size_t AddField(const std::string& name, int rows = 1, int detail = MIN_DETAIL);
+	//finds a field's handle by name, throwing if there is none
+	size_t GetField(const std::string& name) const;
+
+	//sets a field to constant text. only copies when the text actually differs
+	void SetText(size_t field, const char* text, int line = 0);
+
+	//formats the arguments into a field, but only when at least one of them changed since the last call
+	template <typename... Args>
+	inline void Set(size_t field, const char* format, const Args&... args) {
+		static_assert(sizeof...(Args) > 0, "use SetText for fields without arguments");
+		static_assert((std::is_trivially_copyable_v<Args> && ...), "overlay values are compared bytewise");
+
+		unsigned char packed[(sizeof(Args) + ...)];
+		size_t offset = 0;
+		((memcpy(packed + offset, &args, sizeof(Args)), offset += sizeof(Args)), ...);
+
+		Field& f = fields[field];
+		if (Changed(f, packed, sizeof(packed)))
+			Format(f, 0, format, args...);
+	}
+
+	//shows a labelled 4x4 matrix, one row per line. the field needs five rows
+	void SetMatrix(size_t field, const char* label, const glm::mat4& mat);
+
+	inline void SetDetail(int newDetail) { detail = newDetail; }
+	inline int GetDetail(void) const { return detail; }
+
+	//hands the cached lines of the shown fields to the renderer as one block. no formatting happens here
+	void Composite() const;
+};
+
+#endif
@@ -0,0 +1,79 @@
+//Nick Sells, 2024
+
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include <algorithm>
+
+//depth-cued colors for scene geometry. every colored cell gets one of a small, fixed set of color pairs, found with
+//two table lookups: reciprocal depth to a depth band, then band and intensity to a pair. the colors behind the pairs
+//are worked out once, for whatever the terminal supports, and pairs whose colors come out the same on this terminal
+//are merged, so neighboring cells share attributes as often as they can and the presented runs stay long
+class Palette {
+public:
+	enum class Mode : unsigned char {
+		None, //no colors, or not set up. every lookup gives the default pair
+		Basic, //the eight ANSI colors
+		Xterm256, //the 6x6x6 cube and gray ramp of 256-color terminals
+		TrueColor //any 24-bit color, on terminals whose terminfo describes direct color (eg. TERM=xterm-direct)
+	};
+
+	//bands of depth from nearest to farthest, and levels of intensity from dimmest to brightest
+	static constexpr int DEPTH_BANDS = 8;
+	static constexpr int SHADES = 4;
+	//the pairs are numbered from here, band by band, the same on every terminal so that recordings replay alike
+	//pair 0 is the terminal's default and is never redefined
+	static constexpr short FIRST_PAIR = 1;
+	static constexpr int PAIR_COUNT = DEPTH_BANDS * SHADES;
+	//how finely reciprocal depth is looked up across the depth range
+	static constexpr int DEPTH_STEPS = 256;
+
+private:
+	static Mode mode;
+	static bool enabled;
+	static short pairs[DEPTH_BANDS][SHADES];
+	static unsigned char bands[DEPTH_STEPS];
+	static float nearest;
+	static float farthest;
+	static float zMin; //the reciprocal of farthest
+	static float zScale; //steps per unit of reciprocal depth
+
+public:
+	//picks a mode from the terminal's capabilities and sets up the pairs. call after start_color
+	static Mode Init();
+	//fills the tables for a mode without touching the terminal, eg. to color frames rendered headless
+	static void Build(Mode newMode);
+
+	static inline Mode GetMode() { return mode; }
+	static const char* GetModeName();
+	//roughly how many bytes switching to one of the palette's pairs costs in escape sequences
+	static size_t GetColorChangeBytes();
+
+	//depth cueing can be turned off, leaving geometry in the default pair
+	static inline void SetEnabled(bool newEnabled) { enabled = newEnabled; }
+	static inline bool IsCueing() { return enabled && mode != Mode::None; }
+
+	//the range of view-space depths the bands are spread over, eg. a camera's near and far planes
+	//anything nearer or farther gets the first or last band. rebuilds the depth table only if the range changed
+	static void SetDepthRange(float newNearest, float newFarthest);
+	static inline float GetNearest() { return nearest; }
+	static inline float GetFarthest() { return farthest; }
+
+	//the band of a reciprocal view-space depth, as carried through the renderer
+	static inline int GetDepthBand(float z) {
+		int step = (int) ((z - zMin) * zScale);
+		return bands[std::clamp(step, 0, DEPTH_STEPS - 1)];
+	}
+
+	//the pair for a band at an intensity from 0 to SHADES - 1
+	static inline short GetPair(int band, int shade) {
+		return pairs[band][shade];
+	}
+
+	//the pair for a cell of geometry at a reciprocal depth, at full intensity
+	static inline short GetDepthPair(float z) {
+		return pairs[GetDepthBand(z)][SHADES - 1];
+	}
+};
+
+#endif
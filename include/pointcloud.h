@@ -0,0 +1,77 @@
+//Nick Sells, 2024
+
+#ifndef POINTCLOUD_H
+#define POINTCLOUD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/matrix.hpp>
+#include <glm/vec3.hpp>
+
+#include "matrix.h"
+#include "video.h"
+
+//a large set of unconnected points, eg. a lidar scan. unlike a Points model it has no indices, so it isn't limited to
+//what 16-bit indices can address, and it is drawn as a density map rather than one glyph per point
+struct PointCloud {
+
+	//model-space positions with w = 1, laid out so that batches of them can go straight through Matrix4::Transform
+	std::vector<Vector4> points;
+
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+
+	inline PointCloud(void):
+	boundsMin(0.0f), boundsMax(0.0f) {
+	}
+
+	//recomputes the bounds after the points were modified
+	void UpdateBounds(void);
+
+	//loads an .xyz file: one point per line as "x y z", with anything after the third number ignored
+	static PointCloud LoadXyz(const std::string& path);
+};
+
+//counts how many points land in each cell of a viewport, then shades every cell that got any by its count
+//the points are split across the job pool. each thread counts into a histogram of its own, and the histograms are
+//summed once at the end, so threads never contend over a cell
+class DensityBuffer {
+
+private:
+	Video::Viewport viewport;
+	std::vector<std::vector<uint32_t>> histograms; //one per pool thread
+	std::vector<unsigned char> touched; //whether each thread's histogram has been cleared and used since Clear
+	std::vector<uint32_t> density; //the merged counts
+	std::string row; //scratch for building runs of glyphs
+
+public:
+	//how many points each job chunk transforms per batch. small enough that the batch stays in the l1 cache
+	static const size_t BATCH = 256;
+	//the fewest points worth handing to another thread
+	static const size_t GRAIN = 1 << 15;
+
+	inline DensityBuffer(void):
+	viewport{0, 0, 0, 0} {
+	}
+
+	//sizes the buffer to a viewport and empties it
+	void Clear(const Video::Viewport& viewport);
+
+	//projects every point of a cloud and counts the ones that land inside the viewport and between the clip planes
+	void Splat(const PointCloud& cloud, const glm::mat4& PVM);
+
+	//merges the threads' counts and submits the shaded cells to the renderer as runs of text
+	//the densest cell gets the darkest glyph, and the ramp is logarithmic so that sparse areas still show up
+	//while the palette is depth cueing, denser cells are brighter too, in the band for the reciprocal depth z
+	void Submit(float z);
+
+	//the merged count of a cell in the viewport, valid after Submit
+	inline uint32_t GetDensity(int x, int y) const {
+		return density[(size_t) y * viewport.width + x];
+	}
+};
+
+#endif
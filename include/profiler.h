@@ -0,0 +1,65 @@
+//Nick Sells, 2024
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+
+//scoped timing zones for finding out where frame time goes
+//each thread records into its own ring buffer, so recording never locks and old frames fall off the end on their own
+//zones only exist when built with ASCIICAM_PROFILE defined. otherwise PROFILE_ZONE expands to nothing and costs nothing
+namespace Profiler {
+
+	//how many zones each thread keeps before overwriting the oldest
+	static const size_t EVENTS_PER_THREAD = 1 << 16;
+	//how many frame boundaries are remembered, which bounds how far back a dump can reach
+	static const size_t MAX_FRAMES = 256;
+
+	//nanoseconds on a monotonic clock
+	extern uint64_t Now(void);
+
+	//records a finished zone on the calling thread. name must outlive the profiler, so use string literals
+	//NOTE: only the main thread and the job pool may record. DumpTrace reads every buffer without locking, which is only
+	//safe while their threads are known to be idle, so long-running threads like the asset loaders stay out of the trace
+	extern void Record(const char* name, uint64_t start, uint64_t end);
+
+	//marks the start of a frame. call once per frame from the main thread
+	extern void NextFrame(void);
+
+	//writes the zones from the last frames frames to path in the Chrome trace event format, which Perfetto also reads
+	//call it between frames, when no job is running, so no thread is writing to its buffer while it is being read
+	//returns false if the file couldn't be written
+	extern bool DumpTrace(const char* path, size_t frames = 60);
+
+	//times its own lifetime
+	class Zone {
+	private:
+		const char* name;
+		uint64_t start;
+
+	public:
+		inline Zone(const char* name): name(name), start(Now()) {
+		}
+
+		inline ~Zone() {
+			Record(name, start, Now());
+		}
+
+		Zone(const Zone&) = delete;
+		Zone& operator=(const Zone&) = delete;
+	};
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef ASCIICAM_PROFILE
+	#define PROFILE_ZONE(name) Profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+	#define PROFILE_FRAME() Profiler::NextFrame()
+#else
+	#define PROFILE_ZONE(name)
+	#define PROFILE_FRAME()
+#endif
+
+#endif
@@ -0,0 +1,92 @@
+//Nick Sells, 2024
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "framecodec.h"
+
+//records every presented frame to a file in the FrameCodec format, for replaying sessions later
+//every so often a whole frame is stored as a keyframe so that playback can seek without decoding from the start
+//encoding happens on the calling thread and is a single pass over the framebuffer. the file is written by a background thread
+class Recorder {
+private:
+	FILE* file;
+	FrameCodec::Encoder encoder;
+	uint64_t startTime;
+	std::vector<unsigned char> encoded; //scratch space for the frame being encoded, kept to avoid allocating each frame
+
+	//frames waiting for the writer thread. the capturing thread appends, the writer swaps the whole lot out at once
+	std::thread writer;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::vector<unsigned char> pending;
+	bool closing;
+
+	void WriterLoop(void);
+
+public:
+	//a keyframe is also forced whenever the screen size changes
+	static const unsigned long KEYFRAME_INTERVAL = 120;
+
+	//opens path for writing, throwing if it can't
+	Recorder(const std::string& path);
+	//writes out everything still pending and closes the file
+	~Recorder();
+
+	Recorder(const Recorder&) = delete;
+	Recorder& operator=(const Recorder&) = delete;
+
+	//encodes a frame and hands it to the writer
+	void Capture(const Video::Cell* cells, int width, int height);
+
+	inline unsigned long GetFrameCount(void) const {
+		return encoder.GetFrameCount();
+	}
+};
+
+//reads a recording back, one frame at a time or by seeking
+class Playback {
+public:
+	typedef FrameCodec::Frame Frame;
+
+private:
+	struct IndexEntry {
+		long offset; //where the payload starts
+		uint32_t size;
+		Frame frame;
+	};
+
+	FILE* file;
+	std::vector<IndexEntry> index; //every frame's header, gathered when the file is opened
+	size_t nextFrame;
+	std::vector<unsigned char> payload;
+
+public:
+	//opens a recording and indexes its frames, throwing if it isn't one
+	Playback(const std::string& path);
+	~Playback();
+
+	Playback(const Playback&) = delete;
+	Playback& operator=(const Playback&) = delete;
+
+	inline size_t GetFrameCount(void) const {
+		return index.size();
+	}
+
+	//applies the next frame to cells, which must hold the frame before it (or anything, if the next frame is a keyframe)
+	//returns false at the end of the recording
+	bool Next(std::vector<Video::Cell>& cells, Frame& frame);
+
+	//jumps to a frame by decoding forward from the nearest keyframe at or before it. the next call to Next returns the one after
+	void Seek(size_t frameNumber, std::vector<Video::Cell>& cells, Frame& frame);
+};
+
+#endif
@@ -3,18 +3,97 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
-#include "video.h"
+#include <cstddef>
+#include <string>
+#include <vector>
 
 #include <glm/vec3.hpp>
 
+#include "depthbuffer.h"
+#include "video.h"
+
+//retained-mode command buffer that sits between the camera/ui code and the video layer
+//primitives are recorded during the frame and executed in one pass by Flush(), grouped by color pair
+//so that attribute state (and the escape sequences behind it) changes once per batch instead of once per primitive
 class Renderer {
 
 public:
 
-	static void RenderPoints(const glm::vec3* screenVerts, const bool* visible, const std::vector<unsigned short> indices) {
-		
-	}
+	enum class CommandType : unsigned char {
+		Point = 0,
+		Line = 1,
+		Triangle = 2,
+		Text = 3
+	};
+
+	//a single recorded primitive. text commands keep their characters in a shared pool
+	//and reference them by offset so that recording never allocates per command
+	//depth-tested commands carry reciprocal depth in z0..z2 and get hidden behind surfaces in hidden-line mode
+	//every command is clipped to the viewport that was current when it was recorded, referenced by index
+	struct Command {
+		CommandType type;
+		short pairIndex;
+		bool depthTested;
+		unsigned char viewport;
+		float x0, y0, z0;
+		float x1, y1, z1;
+		float x2, y2, z2;
+		unsigned int textOffset;
+		unsigned int textLength;
+	};
+
+	//the pair index used by primitives that don't ask for a color
+	static constexpr short DEFAULT_PAIR = 0;
+
+	//how many different viewports one frame's commands can be drawn into
+	static constexpr size_t MAX_VIEWPORTS = 256;
+
+private:
+	static std::vector<Command> commands;
+	static std::string textPool;
+	static std::vector<Video::Viewport> viewports; //the first stands for the whole screen, whatever its size at Flush
+	static unsigned char currentViewport;
+
+	static bool hiddenLines;
+	static bool depthReady;
+	static DepthBuffer depth;
+
+	static void Execute(const Command& cmd);
+	static Video::Viewport ResolveViewport(unsigned char index);
+
+public:
+	static void SubmitPoint(float x, float y, short pairIndex = DEFAULT_PAIR);
+	static void SubmitLine(float x0, float y0, float x1, float y1, short pairIndex = DEFAULT_PAIR);
+	static void SubmitTriangle(float x0, float y0, float x1, float y1, float x2, float y2, short pairIndex = DEFAULT_PAIR);
+	static void SubmitText(float x, float y, const char* text, size_t len, short pairIndex = DEFAULT_PAIR);
+
+	//the same primitives for scene geometry: screen-space x and y plus reciprocal depth in z
+	static void SubmitPoint(const glm::vec3& v0, short pairIndex = DEFAULT_PAIR);
+	static void SubmitLine(const glm::vec3& v0, const glm::vec3& v1, short pairIndex = DEFAULT_PAIR);
+	static void SubmitTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, short pairIndex = DEFAULT_PAIR);
+
+	//in hidden-line mode, fills a solid triangle into the depth buffer right away so that it can hide lines at Flush
+	//does nothing otherwise. surfaces must all be submitted before Flush, but in any order relative to the lines
+	static void SubmitSurface(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2);
+
+	//hidden-line mode keeps the wireframe look but draws only the parts of lines that aren't behind a surface
+	static void SetHiddenLines(bool enabled);
+	static bool GetHiddenLines();
+
+	//clips everything recorded from now on to part of the screen, eg. for one camera's view in a split screen
+	//throws if a frame uses more than MAX_VIEWPORTS different viewports
+	static void SetViewport(const Video::Viewport& viewport);
+	//goes back to drawing over the whole screen
+	static void ResetViewport();
+
+	//executes every recorded command, batched by color pair, then empties the buffer
+	static void Flush();
+	//empties the buffer without drawing anything
+	static void Discard();
 
+	static size_t GetCommandCount();
+	//the commands recorded so far this frame, in submission order
+	static const std::vector<Command>& GetCommands();
 };
 
 #endif
@@ -0,0 +1,19 @@
+//Nick Sells, 2024
+
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+#include "model.h"
+
+//mesh simplification by quadric error metric edge collapse (Garland & Heckbert, 1997)
+namespace Simplify {
+
+	//meshes smaller than this aren't worth a LOD of their own
+	static const size_t MIN_TRIANGLES = 16;
+
+	//collapses edges of a triangle mesh, cheapest first, until it has at most targetTriangles triangles
+	//or no collapse is left that wouldn't fold the surface over. the result is compacted to only the verts still in use
+	extern Model Decimate(const Model& model, size_t targetTriangles);
+};
+
+#endif
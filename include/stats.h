@@ -0,0 +1,66 @@
+//Nick Sells, 2024
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//hard per-frame counters, to go alongside the profiler's timings
+//every thread counts into its own block without locking, and EndFrame drains the blocks into the frame's totals
+namespace Stats {
+
+	enum Counter : unsigned int {
+		ObjectsSubmitted,
+		ObjectsCulled,
+		VerticesTransformed,
+		ObjectsReused, //drawn from screen-space verts a camera cached on an earlier frame
+		PrimitivesClipped, //lines not entirely inside their viewport, whether cut down or thrown out
+		PrimitivesDrawn, //points, lines and triangles that wrote a cell after clipping and depth testing. text isn't counted
+		CellsWritten,
+		CellsChanged,
+		BytesSent, //estimated from the cells, cursor moves and color changes sent
+		Allocations,
+		ArenaBytes, //handed out by the frame arenas, only counted in ASCIICAM_ARENA_DEBUG builds
+		COUNTER_COUNT
+	};
+
+	//threads past this many share the last block, where they can lose counts to each other
+	static const unsigned int MAX_THREADS = 256;
+
+	//one thread's counters, padded out to its own cache lines so that threads never fight over them
+	//the values are atomic only so that EndFrame can drain them while background threads (asset loaders, the recorder's
+	//writer) keep counting. relaxed loads and stores compile to plain moves, so counting still costs no more than before
+	struct alignas(64) Block {
+		std::atomic<uint64_t> values[COUNTER_COUNT];
+	};
+
+	extern thread_local Block* localBlock;
+	extern Block* RegisterThread(void);
+
+	//counts on the calling thread. no read-modify-write or locks, since only the owning thread ever adds to its block
+	static inline void Add(Counter counter, uint64_t amount = 1) {
+		Block* block = localBlock;
+		if (block == nullptr)
+			block = RegisterThread();
+		std::atomic<uint64_t>& value = block->values[counter];
+		value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+	}
+
+	//sums and resets every thread's counters, making them the last frame's totals, and logs them if a log is open
+	//call it between frames, when no job is running. threads outside the job pool may still be counting, and what they
+	//count right as the frame ends may go to the wrong frame, or now and then to both
+	extern void EndFrame(void);
+
+	//the totals from the last call to EndFrame
+	extern uint64_t Get(Counter counter);
+	extern const char* GetName(Counter counter);
+
+	//appends a line to path for every frame from now on. paths ending in .json or .jsonl get json lines, anything else csv
+	//returns false if the file couldn't be opened
+	extern bool OpenLog(const char* path);
+	extern void CloseLog(void);
+};
+
+#endif
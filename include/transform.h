@@ -0,0 +1,126 @@
+//Nick Sells, 2024
+
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include <algorithm>
+#include <vector>
+
+#include <glm/matrix.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+//a node in the transform hierarchy. each node owns a local matrix and lazily caches its world matrix,
+//which is only recomputed after the node or one of its ancestors changed
+//NOTE: copying a transform copies only its local matrix; the copy starts out without a parent or children
+class Transform {
+
+private:
+	glm::mat4 local;
+	mutable glm::mat4 world;
+	mutable bool dirty;
+	unsigned long version;
+	Transform* parent;
+	std::vector<Transform*> children;
+
+	//hands out versions that are unique across all transforms, so a cache keyed on (transform, version)
+	//can't be fooled by a different transform reusing the same address
+	static inline unsigned long NextVersion(void) {
+		static unsigned long counter = 0;
+		return ++counter;
+	}
+
+	//flags this node and everything below it for recomputation. the node's version changes on every call,
+	//even when it was already dirty, so that each change to its local matrix gets a version of its own
+	//a dirty node's descendants are dirty too, and none of their world matrices has been read since their versions
+	//last changed, so propagation can stop at one
+	inline void MarkDirty(void) {
+		version = NextVersion();
+		if (dirty)
+			return;
+		dirty = true;
+		for (Transform* child : children)
+			child->MarkDirty();
+	}
+
+	inline void Detach(void) {
+		if (parent != nullptr) {
+			auto& siblings = parent->children;
+			siblings.erase(std::remove(siblings.begin(), siblings.end(), this), siblings.end());
+			parent = nullptr;
+		}
+	}
+
+public:
+	inline Transform(const glm::mat4& local = glm::mat4(1.0f)):
+	local(local), world(local), dirty(true), version(NextVersion()), parent(nullptr) {
+	}
+
+	inline Transform(const Transform& other):
+	Transform(other.local) {
+	}
+
+	//assigns only the local matrix; this node keeps its place in the hierarchy
+	inline Transform& operator=(const Transform& other) {
+		SetLocal(other.local);
+		return *this;
+	}
+
+	inline ~Transform(void) {
+		Detach();
+		for (Transform* child : children) {
+			child->parent = nullptr;
+			child->MarkDirty();
+		}
+	}
+
+	inline const glm::mat4& GetLocal(void) const {
+		return local;
+	}
+
+	inline void SetLocal(const glm::mat4& mat) {
+		local = mat;
+		MarkDirty();
+	}
+
+	//moves the node by an offset expressed in its parent's space
+	inline void Translate(const glm::vec3& delta) {
+		local[3] += glm::vec4(delta, 0.0f);
+		MarkDirty();
+	}
+
+	//rotates the node about one of its own axes
+	inline void Rotate(float radians, const glm::vec3& axis) {
+		local = glm::rotate(local, radians, axis);
+		MarkDirty();
+	}
+
+	//returns the local-to-world matrix, recomputing it only if something up the chain changed
+	inline const glm::mat4& GetWorld(void) const {
+		if (dirty) {
+			world = (parent != nullptr) ? parent->GetWorld() * local : local;
+			dirty = false;
+		}
+		return world;
+	}
+
+	//changes when the world matrix may have changed. caches compare against this instead of the matrix itself
+	inline unsigned long GetVersion(void) const {
+		return version;
+	}
+
+	inline Transform* GetParent(void) const {
+		return parent;
+	}
+
+	//reparents this node. passing nullptr makes it a root
+	inline void SetParent(Transform* newParent) {
+		Detach();
+		parent = newParent;
+		if (parent != nullptr)
+			parent->children.push_back(this);
+		dirty = false; //force the propagation below even if we were already dirty
+		MarkDirty();
+	}
+};
+
+#endif
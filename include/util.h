@@ -33,5 +33,18 @@ namespace Util {
 			stream << std::fixed << std::setprecision(precision) << std::setw(chars) << vec[i] << " ";
 		stream << ")\n";
 	}
+
+	//inverts a matrix made only of rotation and translation by transposing the rotation and counter-rotating the translation
+	//NOTE: this is only correct when the upper 3x3 is orthonormal, ie. there is no scale or shear
+	static inline glm::mat4 RigidInverse(const glm::mat4& mat) {
+		glm::mat4 result(1.0f);
+		for(int col = 0; col < 3; col++)
+			for(int row = 0; row < 3; row++)
+				result[col][row] = mat[row][col];
+		glm::vec3 t(mat[3]);
+		for(int row = 0; row < 3; row++)
+			result[3][row] = -(mat[row][0] * t.x + mat[row][1] * t.y + mat[row][2] * t.z);
+		return result;
+	}
 }
 #endif
@@ -3,19 +3,21 @@
 #ifndef VECTOR_H
 #define VECTOR_H
 
-#include <array>
+#include <algorithm>
 #include <cassert>
 #include <cmath>
-#include <cstring>
-#include <concepts>
+#include <cstddef>
 #include <iomanip>
 #include <ostream>
 
-#include "util.h"
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 
 //an N-dimensional vector
+//4D vectors are aligned to 16 bytes so that a whole one fits a single SSE register
 template <size_t N>
-struct Vector {
+struct alignas(N == 4 ? 16 : alignof(float)) Vector {
 
 	float elems[N];
 
@@ -34,10 +36,22 @@ struct Vector {
 			this->elems[i] = values[i];
 	}
 
-	//typical copy constructor
-	inline constexpr Vector(const Vector& other) noexcept {
+	//typical copy constructor. defaulted so that vectors stay trivially copyable
+	inline constexpr Vector(const Vector& other) noexcept = default;
+	inline constexpr Vector& operator=(const Vector& other) noexcept = default;
+
+	//converts from the glm vector of the same size
+	inline constexpr Vector(const glm::vec<N,float>& other) noexcept {
 		for(size_t i = 0; i < N; i++)
-			this->elems[i] = other.elems[i];
+			this->elems[i] = other[i];
+	}
+
+	//converts to the glm vector of the same size
+	inline constexpr operator glm::vec<N,float>() const noexcept {
+		glm::vec<N,float> result;
+		for(size_t i = 0; i < N; i++)
+			result[i] = this->elems[i];
+		return result;
 	}
 
 	//an implicit conversion constructor for promoting or demoting vectors to higher or lower dimensions
@@ -52,7 +66,7 @@ struct Vector {
     }
 
 	//allows access to a vector's components via indexing
-	inline float& operator[](size_t elem) noexcept {
+	inline constexpr float& operator[](size_t elem) noexcept {
 		// static_assert(elem < N, "index out of range");
 		assert(elem < N); //index out of range
 		return this->elems[elem];
@@ -60,7 +74,7 @@ struct Vector {
 
 	//allows access to a vector's components via indexing
 	//NOTE: this overload is necessary to access elements of vectors passed as const references
-	inline float operator[](size_t elem) const noexcept {
+	inline constexpr float operator[](size_t elem) const noexcept {
 		// static_assert(elem < N, "index out of range");
 		assert(elem < N); //index out of range
 		return this->elems[elem];
@@ -143,7 +157,7 @@ struct Vector {
 		
 		static_assert(N == 3, "cross product is defined only for vectors of three dimensions");
 
-		Vector result;
+		Vector<3> result;
 		result.elems[0] = this->elems[1]*other.elems[2] - this->elems[2]*other.elems[1];
 		result.elems[1] = this->elems[2]*other.elems[0] - this->elems[0]*other.elems[2];
 		result.elems[2] = this->elems[0]*other.elems[1] - this->elems[1]*other.elems[0];
@@ -4,13 +4,68 @@
 #ifndef VIDEO_H
 #define VIDEO_H
 
+#include <cstddef>
+#include <vector>
+
+class Broadcaster;
+class DepthBuffer;
+class Recorder;
+
+//everything is drawn into an in-memory framebuffer of cells first. Refresh then presents it, either to the terminal
+//through ncurses (sending only the cells that changed) or, when headless, nowhere at all
 class Video {
+public:
+	struct Cell {
+		char ch;
+		short pairIndex;
+
+		inline bool operator==(const Cell& other) const {
+			return ch == other.ch && pairIndex == other.pairIndex;
+		}
+	};
+
+	//a rectangle of cells, for confining drawing to part of the screen
+	struct Viewport {
+		int x;
+		int y;
+		int width;
+		int height;
+
+		inline bool operator==(const Viewport& other) const {
+			return x == other.x && y == other.y && width == other.width && height == other.height;
+		}
+	};
+
 private:
 	static bool initialized;
+	static bool headless;
 	static bool useColor;
 
+	static int width;
+	static int height;
+	static short currentPair;
+	static std::vector<Cell> framebuffer;
+	static std::vector<Cell> presented; //what the terminal is showing, so Refresh can skip unchanged cells
+	static size_t cellsWritten; //since the last refresh, for the stats counters
+	static Recorder* recorder;
+	static Broadcaster* broadcaster;
+	static Viewport viewport; //what drawing is clipped to, always within the screen
+
 	static unsigned int GetSectorCode(float x, float y);
-	static bool CohenSutherlandLineClip(float& x0, float& y0, float& x1, float& y1);
+	static void Resize(int newWidth, int newHeight);
+
+	//writes a cell in a color pair, ignoring anything outside the viewport. returns whether it was written
+	static inline bool SetCell(int x, int y, char ch, short pairIndex) {
+		if (x < viewport.x || y < viewport.y || x >= viewport.x + viewport.width || y >= viewport.y + viewport.height) return false;
+		framebuffer[(size_t) y * width + x] = {ch, pairIndex};
+		cellsWritten++;
+		return true;
+	}
+
+	//likewise in the current color
+	static inline bool SetCell(int x, int y, char ch) {
+		return SetCell(x, y, ch, currentPair);
+	}
 
 public:
 	static unsigned int GetScreenWidth();
@@ -18,16 +73,54 @@ public:
 	static float GetAspectRatio();
 
 	static void Init();
+	//sets up a framebuffer of the given size without touching the terminal, for benchmarks and offline rendering
+	static void InitHeadless(int width, int height);
 	static void Deinit();
 
+	static inline bool IsHeadless() { return headless; }
+
+	//the framebuffer as of the last draw call, row by row
+	static inline const std::vector<Cell>& GetFramebuffer() { return framebuffer; }
+
+	//hands every frame presented from now on to a recorder, or stops recording if it is null
+	static inline void SetRecorder(Recorder* newRecorder) { recorder = newRecorder; }
+	//likewise for a broadcaster serving frames to viewers
+	static inline void SetBroadcaster(Broadcaster* newBroadcaster) { broadcaster = newBroadcaster; }
+
+	//copies a whole frame of cells into the framebuffer, cropping it to the screen. used for replaying recordings
+	static void Blit(const std::vector<Cell>& cells, int width, int height);
+
+	//the whole screen as a viewport
+	static inline Viewport GetScreenViewport() { return {0, 0, width, height}; }
+
+	//confines all drawing to part of the screen until the next ResetViewport. the part off screen is ignored
+	//a resize resets the viewport to the whole screen
+	static void SetViewport(const Viewport& newViewport);
+	static inline void ResetViewport() { viewport = GetScreenViewport(); }
+	static inline const Viewport& GetViewport() { return viewport; }
+
+	//clips a line to the viewport, returning false if none of it is inside
+	static bool CohenSutherlandLineClip(float& x0, float& y0, float& x1, float& y1);
+
 	static void Refresh();
 	static void Clear();
 
-	static void PlotPixel(float x, float y);
+	//the plots without a color return whether they wrote any cell, so that only what reaches the screen counts as drawn
+	static bool PlotPixel(float x, float y);
 	static void PlotPixel(float x, float y, int pairIndex);
+	//plots scene geometry at a reciprocal depth z. skipped if depth is given and the cell is behind its surfaces,
+	//and depth cued through the palette unless a color is active
+	static bool PlotPixel(float x, float y, float z, const DepthBuffer* depth);
 
-	static void PlotLine(float x0, float y0, float x1, float y1);
+	static bool PlotLine(float x0, float y0, float x1, float y1);
 	static void PlotLine(float x0, float y0, float x1, float y1, int pairIndex);
+	//likewise for a line of scene geometry, with z stepped along it
+	static bool PlotLine(float x0, float y0, float z0, float x1, float y1, float z1, const DepthBuffer* depth);
+
+	static void PlotText(float x, float y, const char* text, size_t len);
+
+	static void BeginColor(int pairIndex);
+	static void EndColor(int pairIndex);
 };
 
 #endif
@@ -1,11 +0,0 @@
-//Nick Sells, 2023
-
-#ifndef MATH_H
-#define MATH_H
-
-namespace Math {
-	#include "matrix.h"
-	#include "vector.h"
-}
-
-#endif
\ No newline at end of file
@@ -0,0 +1,112 @@
+//Nick Sells, 2024
+
+#include "animation.h"
+#include "jobs.h"
+#include "profiler.h"
+
+#include <cmath>
+
+static const float PI = 3.14159265358979f;
+
+//a branch-free sine, accurate to about 1e-6, that vectorizes where std::sin becomes a library call
+//reduces to [-pi, pi], folds into [-pi/2, pi/2] and evaluates a taylor polynomial. the reduction rounds through an int,
+//since std::floor is a library call too without SSE4.1, so x must stay within about 1e10
+static inline float BatchSin(float x) {
+	float turns = x * (0.5f / PI);
+	x -= 2.0f * PI * (float) (int) (turns + std::copysign(0.5f, turns));
+	//sin is symmetric about pi/2, so |x| folds to pi/2 - |(|x| - pi/2)| with plain arithmetic rather than a select,
+	//which gcc would turn back into a branch
+	x = std::copysign(0.5f * PI - std::fabs(std::fabs(x) - 0.5f * PI), x);
+	float x2 = x * x;
+	return x * (1.0f + x2 * (-1.0f / 6.0f + x2 * (1.0f / 120.0f + x2 * (-1.0f / 5040.0f + x2 * (1.0f / 362880.0f)))));
+}
+
+size_t Animation::Add(ObjectHandle target, const AnimationParams& params) {
+	glm::vec3 axis = glm::normalize(params.axis);
+	targets.push_back(target);
+	centerX.push_back(params.center.x); centerY.push_back(params.center.y); centerZ.push_back(params.center.z);
+	axisX.push_back(axis.x); axisY.push_back(axis.y); axisZ.push_back(axis.z);
+	speed.push_back(params.speed);
+	offsetX.push_back(params.offset.x); offsetY.push_back(params.offset.y); offsetZ.push_back(params.offset.z);
+	amplitudeX.push_back(params.amplitude.x); amplitudeY.push_back(params.amplitude.y); amplitudeZ.push_back(params.amplitude.z);
+	frequency.push_back(params.frequency);
+	phase.push_back(params.phase);
+	results.emplace_back(1.0f);
+	return targets.size() - 1;
+}
+
+void Animation::Remove(size_t index) {
+	auto removeAt = [index](auto& array) {
+		array[index] = array.back();
+		array.pop_back();
+	};
+	removeAt(targets);
+	removeAt(centerX); removeAt(centerY); removeAt(centerZ);
+	removeAt(axisX); removeAt(axisY); removeAt(axisZ);
+	removeAt(speed);
+	removeAt(offsetX); removeAt(offsetY); removeAt(offsetZ);
+	removeAt(amplitudeX); removeAt(amplitudeY); removeAt(amplitudeZ);
+	removeAt(frequency);
+	removeAt(phase);
+	removeAt(results);
+}
+
+//builds the matrices for one range of animations. every iteration runs the same instructions, with no calls or branches,
+//so the loop vectorizes across animations (check with -fopt-info-vec-optimized)
+void Animation::Evaluate(size_t begin, size_t end, float time) {
+	//the arrays are read through restrict pointers so the compiler knows the results can't overwrite them. gcc doesn't
+	//act on restrict locals by itself, so the simd pragma makes the same promise for the loop, and also vectorizes it at
+	//-O2, whose cost model would otherwise turn down a loop with an unknown trip count
+	const float* __restrict speed = this->speed.data();
+	const float* __restrict axisX = this->axisX.data();
+	const float* __restrict axisY = this->axisY.data();
+	const float* __restrict axisZ = this->axisZ.data();
+	const float* __restrict centerX = this->centerX.data();
+	const float* __restrict centerY = this->centerY.data();
+	const float* __restrict centerZ = this->centerZ.data();
+	const float* __restrict offsetX = this->offsetX.data();
+	const float* __restrict offsetY = this->offsetY.data();
+	const float* __restrict offsetZ = this->offsetZ.data();
+	const float* __restrict amplitudeX = this->amplitudeX.data();
+	const float* __restrict amplitudeY = this->amplitudeY.data();
+	const float* __restrict amplitudeZ = this->amplitudeZ.data();
+	const float* __restrict frequency = this->frequency.data();
+	const float* __restrict phase = this->phase.data();
+	float* __restrict out = &results[0][0][0];
+	#pragma omp simd
+	for (size_t i = begin; i < end; i++) {
+		float angle = speed[i] * time;
+		float s = BatchSin(angle);
+		float c = BatchSin(angle + 0.5f * PI);
+		float t = 1.0f - c;
+		float ax = axisX[i], ay = axisY[i], az = axisZ[i];
+
+		//rodrigues' rotation formula, the same matrix glm::rotate builds
+		float r00 = t*ax*ax + c,    r01 = t*ax*ay - s*az, r02 = t*ax*az + s*ay;
+		float r10 = t*ax*ay + s*az, r11 = t*ay*ay + c,    r12 = t*ay*az - s*ax;
+		float r20 = t*ax*az - s*ay, r21 = t*ay*az + s*ax, r22 = t*az*az + c;
+
+		float bob = BatchSin(frequency[i] * time + phase[i]);
+		float px = offsetX[i] + amplitudeX[i] * bob;
+		float py = offsetY[i] + amplitudeY[i] * bob;
+		float pz = offsetZ[i] + amplitudeZ[i] * bob;
+
+		//column-major, like glm
+		float* m = out + 16 * i;
+		m[0] = r00; m[1] = r10; m[2] = r20; m[3] = 0.0f;
+		m[4] = r01; m[5] = r11; m[6] = r21; m[7] = 0.0f;
+		m[8] = r02; m[9] = r12; m[10] = r22; m[11] = 0.0f;
+		m[12] = centerX[i] + r00*px + r01*py + r02*pz;
+		m[13] = centerY[i] + r10*px + r11*py + r12*pz;
+		m[14] = centerZ[i] + r20*px + r21*py + r22*pz;
+		m[15] = 1.0f;
+	}
+}
+
+void Animation::Update(Level& level, float time) {
+	PROFILE_ZONE("Animation::Update");
+	Jobs::ParallelFor(targets.size(), 1024, [&](size_t begin, size_t end, unsigned int) {
+		Evaluate(begin, end, time);
+	});
+	level.SetTransforms(targets.data(), results.data(), targets.size());
+}
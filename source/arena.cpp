@@ -0,0 +1,127 @@
+//Nick Sells, 2024
+
+#include "arena.h"
+#include "stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+	struct Block {
+		char* data;
+		size_t size;
+	};
+
+	//one thread's arena. only its own thread touches it, apart from EndFrame reading the counts between jobs
+	struct ThreadArena {
+		std::vector<Block> blocks;
+		size_t current = 0; //the block being bumped through
+		size_t offset = 0;
+		unsigned long epoch = 0; //the frame the arena was last rewound for
+		size_t frameBytes = 0;
+		unsigned int index;
+
+		ThreadArena(void);
+		~ThreadArena();
+	};
+}
+
+//bumped by EndFrame. an arena whose epoch is behind rewinds before its next allocation
+static std::atomic<unsigned long> epoch(1);
+static std::atomic<unsigned int> arenaCount(0);
+static std::atomic<ThreadArena*> arenas[Arena::MAX_THREADS];
+static thread_local ThreadArena localArena;
+
+static size_t frameBytes = 0;
+static size_t peakBytes = 0;
+
+ThreadArena::ThreadArena(void):
+index(arenaCount.fetch_add(1)) {
+	if (index < Arena::MAX_THREADS)
+		arenas[index] = this;
+}
+
+ThreadArena::~ThreadArena() {
+	if (index < Arena::MAX_THREADS)
+		arenas[index] = nullptr;
+	for (Block& block : blocks)
+		::operator delete(block.data);
+}
+
+//starts the arena over for a new frame, merging its blocks into one if the last frame overflowed the first
+static void Rewind(ThreadArena& arena, unsigned long now) {
+	if (arena.blocks.size() > 1) {
+		size_t total = 0;
+		for (Block& block : arena.blocks) {
+			total += block.size;
+			::operator delete(block.data);
+		}
+		arena.blocks.clear();
+		arena.blocks.push_back({(char*) ::operator new(total), total});
+	}
+#ifdef ASCIICAM_ARENA_DEBUG
+	for (Block& block : arena.blocks)
+		memset(block.data, 0xcd, block.size);
+#endif
+	arena.current = 0;
+	arena.offset = 0;
+	arena.frameBytes = 0;
+	arena.epoch = now;
+}
+
+void* Arena::Allocate(size_t size, size_t align) {
+	ThreadArena& arena = localArena;
+	unsigned long now = epoch.load(std::memory_order_relaxed);
+	if (arena.epoch != now)
+		Rewind(arena, now);
+	size = std::max<size_t>(size, 1);
+#ifdef ASCIICAM_ARENA_DEBUG
+	arena.frameBytes += size;
+#endif
+
+	while (true) {
+		if (arena.current == arena.blocks.size()) {
+			//each new block at least doubles what the arena holds, so a growing frame only takes a few
+			size_t held = arena.blocks.empty() ? 0 : arena.blocks.back().size;
+			size_t blockSize = std::max({BLOCK_SIZE, size + align, held * 2});
+			arena.blocks.push_back({(char*) ::operator new(blockSize), blockSize});
+			arena.offset = 0;
+		}
+		Block& block = arena.blocks[arena.current];
+		size_t start = (arena.offset + align - 1) & ~(align - 1);
+		if (start + size <= block.size) {
+			arena.offset = start + size;
+			return block.data + start;
+		}
+		arena.current++;
+		arena.offset = 0;
+	}
+}
+
+void Arena::EndFrame(void) {
+#ifdef ASCIICAM_ARENA_DEBUG
+	//arenas that haven't rewound for this frame weren't used in it
+	unsigned long now = epoch.load(std::memory_order_relaxed);
+	frameBytes = 0;
+	unsigned int count = std::min(arenaCount.load(), MAX_THREADS);
+	for (unsigned int i = 0; i < count; i++) {
+		const ThreadArena* arena = arenas[i].load();
+		if (arena != nullptr && arena->epoch == now)
+			frameBytes += arena->frameBytes;
+	}
+	peakBytes = std::max(peakBytes, frameBytes);
+	Stats::Add(Stats::ArenaBytes, frameBytes);
+#endif
+	epoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t Arena::GetFrameBytes(void) {
+	return frameBytes;
+}
+
+size_t Arena::GetPeakBytes(void) {
+	return peakBytes;
+}
@@ -0,0 +1,186 @@
+//Nick Sells, 2024
+
+#include "assets.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <stdexcept>
+
+extern "C" {
+#include <sys/inotify.h>
+#include <unistd.h>
+}
+
+//paths are compared after normalizing, so that "data/a.obj" and "./data/a.obj" are the same file
+static std::string Normalize(const std::string& path) {
+	return std::filesystem::path(path).lexically_normal().string();
+}
+
+Assets::Assets(const std::string& watchDirectory, unsigned int threads):
+pending(0), stopping(false), watchDirectory(Normalize(watchDirectory)), watchFd(-1) {
+	//editors tend to save by writing a new file and renaming it over the old one, which only shows up as a move
+	watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (watchFd >= 0 && inotify_add_watch(watchFd, watchDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+		close(watchFd);
+		watchFd = -1;
+	}
+
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+	for (unsigned int i = 0; i < threads; i++)
+		loaders.emplace_back(&Assets::LoaderLoop, this);
+}
+
+Assets::~Assets() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		requests.clear();
+	}
+	wake.notify_all();
+	for (std::thread& loader : loaders)
+		loader.join();
+	if (watchFd >= 0)
+		close(watchFd);
+}
+
+void Assets::LoaderLoop(void) {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		wake.wait(lock, [this] { return stopping || !requests.empty(); });
+		if (stopping)
+			return;
+		Request request = std::move(requests.front());
+		requests.pop_front();
+		lock.unlock();
+
+		Result result = {request.isLevel, request.asset, request.generation, std::nullopt, {}, {}};
+		//no profiler zone here: the loaders run across frame boundaries, while DumpTrace may be reading their buffers
+		try {
+			if (request.isLevel)
+				result.entries = Level::ReadMap(request.path);
+			else
+				result.model.emplace(Model::LoadObj(request.path, request.quantize));
+		}
+		catch (const std::exception& e) {
+			result.error = e.what();
+		}
+
+		lock.lock();
+		finished.push_back(std::move(result));
+	}
+}
+
+void Assets::Queue(bool isLevel, size_t asset) {
+	Request request;
+	request.isLevel = isLevel;
+	request.asset = asset;
+	if (isLevel) {
+		request.generation = ++levels[asset].generation;
+		request.path = levels[asset].path;
+		request.quantize = false;
+	}
+	else {
+		request.generation = ++models[asset].generation;
+		request.path = models[asset].path;
+		request.quantize = models[asset].quantize;
+	}
+	pending++;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		requests.push_back(std::move(request));
+	}
+	wake.notify_one();
+}
+
+ModelHandle Assets::LoadModel(Level& level, const std::string& path, bool quantize) {
+	std::string normalized = Normalize(path);
+	for (const ModelAsset& asset : models)
+		if (asset.level == &level && asset.path == normalized)
+			return asset.handle;
+
+	ModelHandle handle = level.AddModel(Model({}, {}, Model::Primitive::Points));
+	models.push_back({normalized, quantize, &level, handle, 0});
+	Queue(false, models.size() - 1);
+	return handle;
+}
+
+void Assets::LoadLevel(Level& level, const std::string& path) {
+	levels.push_back({Normalize(path), &level, {}, 0});
+	Queue(true, levels.size() - 1);
+}
+
+void Assets::Install(Result& result) {
+	pending--;
+	unsigned long latest = result.isLevel ? levels[result.asset].generation : models[result.asset].generation;
+	if (result.generation != latest)
+		return; //a newer load of the same file is on its way
+	if (!result.error.empty()) {
+		lastError = result.error;
+		return;
+	}
+
+	if (!result.isLevel) {
+		ModelAsset& asset = models[result.asset];
+		asset.level->ReplaceModel(asset.handle, std::move(*result.model));
+		return;
+	}
+
+	//LoadModel may grow levels, so the asset is looked up again rather than held by reference
+	Level& level = *levels[result.asset].level;
+	std::vector<ObjectHandle> objects;
+	for (const Level::MapEntry& entry : result.entries)
+		objects.push_back(level.AddObject(entry.GetTransform(), LoadModel(level, entry.model, true)));
+	for (ObjectHandle handle : levels[result.asset].objects)
+		if (level.IsValid(handle))
+			level.RemoveObject(handle);
+	levels[result.asset].objects = std::move(objects);
+}
+
+void Assets::Reload(const std::string& path) {
+	for (size_t i = 0; i < models.size(); i++)
+		if (models[i].path == path)
+			Queue(false, i);
+	for (size_t i = 0; i < levels.size(); i++)
+		if (levels[i].path == path)
+			Queue(true, i);
+}
+
+void Assets::PollWatch(void) {
+	if (watchFd < 0)
+		return;
+
+	//a save usually makes several events for the same file, so each changed path is only reloaded once
+	std::vector<std::string> changed;
+	alignas(inotify_event) char buffer[4096];
+	while (true) {
+		ssize_t count = read(watchFd, buffer, sizeof(buffer));
+		if (count <= 0)
+			break;
+		for (char* at = buffer; at < buffer + count;) {
+			const inotify_event* event = (const inotify_event*) at;
+			if (event->len > 0)
+				changed.push_back(Normalize(watchDirectory + "/" + event->name));
+			at += sizeof(inotify_event) + event->len;
+		}
+	}
+	std::sort(changed.begin(), changed.end());
+	changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+	for (const std::string& path : changed)
+		Reload(path);
+}
+
+void Assets::Update(void) {
+	PROFILE_ZONE("Assets::Update");
+	PollWatch();
+
+	std::vector<Result> ready;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		ready.swap(finished);
+	}
+	for (Result& result : ready)
+		Install(result);
+}
@@ -0,0 +1,297 @@
+//Nick Sells, 2024
+//batch.cpp
+//renders a camera path through a level without a terminal, for turntables and regression captures
+//usage: batch <level.map> <camera.path> [--frames <n>] [--size <w>x<h>] [--fps <rate>] [--far <distance>] [--jobs <n>] [--out <directory>] [--record <recording>]
+//"--out" writes each frame as frame_00000.txt and so on, "--record" writes a recording the player can replay. one is needed
+//frames don't depend on each other, so they are shared out among worker processes, one per core unless --jobs says otherwise.
+//the framebuffer and renderer belong to the whole process, which is why the workers are processes rather than threads
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "arena.h"
+#include "camera.h"
+#include "framecodec.h"
+#include "level.h"
+#include "recorder.h"
+#include "video.h"
+
+//one line of a .path file: the camera's position and the point it looks at, at some time
+struct Key {
+	float time;
+	glm::vec3 position;
+	glm::vec3 target;
+	float fov;
+};
+
+//reads a .path file, one key per line as: <seconds> {x,y,z} {tx,ty,tz} <fov>
+//blank lines and lines starting with # are skipped. keys must be in order of time
+static std::vector<Key> ReadPath(const std::string& path) {
+	std::ifstream file(path);
+	if (!file)
+		throw std::runtime_error("could not open " + path);
+
+	std::vector<Key> keys;
+	std::string line;
+	for (int number = 1; std::getline(file, line); number++) {
+		size_t start = line.find_first_not_of(" \t\r");
+		if (start == std::string::npos || line[start] == '#')
+			continue;
+
+		Key key;
+		int parsed = sscanf(line.c_str() + start, "%f { %f , %f , %f } { %f , %f , %f } %f", &key.time,
+			&key.position.x, &key.position.y, &key.position.z,
+			&key.target.x, &key.target.y, &key.target.z, &key.fov);
+		if (parsed != 8)
+			throw std::runtime_error(path + ":" + std::to_string(number) + ": expected <seconds> {position} {target} <fov>");
+		if (!keys.empty() && key.time <= keys.back().time)
+			throw std::runtime_error(path + ":" + std::to_string(number) + ": keys must go forward in time");
+		keys.push_back(key);
+	}
+	if (keys.empty())
+		throw std::runtime_error(path + " has no keys");
+	return keys;
+}
+
+//passes through b at u = 0 and c at u = 1, curving to suit a and d on either side
+static glm::vec3 CatmullRom(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& d, float u) {
+	float u2 = u * u;
+	float u3 = u2 * u;
+	return 0.5f * ((2.0f * b) + (c - a) * u + (2.0f * a - 5.0f * b + 4.0f * c - d) * u2 + (3.0f * b - a - 3.0f * c + d) * u3);
+}
+
+//the camera's position and target follow a smooth curve through the keys, and its fov changes linearly between them
+static Key Sample(const std::vector<Key>& keys, float time) {
+	if (time <= keys.front().time)
+		return keys.front();
+	if (time >= keys.back().time)
+		return keys.back();
+
+	size_t i = 0;
+	while (keys[i + 1].time < time)
+		i++;
+	//the ends have no neighbor beyond them, so they stand in for it
+	const Key& a = keys[(i == 0) ? 0 : i - 1];
+	const Key& b = keys[i];
+	const Key& c = keys[i + 1];
+	const Key& d = keys[std::min(i + 2, keys.size() - 1)];
+	float u = (time - b.time) / (c.time - b.time);
+
+	Key key;
+	key.time = time;
+	key.position = CatmullRom(a.position, b.position, c.position, d.position, u);
+	key.target = CatmullRom(a.target, b.target, c.target, d.target, u);
+	key.fov = b.fov + (c.fov - b.fov) * u;
+	return key;
+}
+
+//a rigid transform placing the camera at position, looking down its -z axis at target with y as near to up as it can be
+static glm::mat4 LookAt(const glm::vec3& position, const glm::vec3& target) {
+	glm::vec3 back = position - target;
+	back = (glm::length(back) > 1e-6f) ? glm::normalize(back) : glm::vec3(0.0f, 0.0f, 1.0f);
+	glm::vec3 right = glm::cross(glm::vec3(0.0f, 1.0f, 0.0f), back);
+	right = (glm::length(right) > 1e-6f) ? glm::normalize(right) : glm::vec3(1.0f, 0.0f, 0.0f);
+	glm::vec3 up = glm::cross(back, right);
+
+	glm::mat4 world(1.0f);
+	world[0] = glm::vec4(right, 0.0f);
+	world[1] = glm::vec4(up, 0.0f);
+	world[2] = glm::vec4(back, 0.0f);
+	world[3] = glm::vec4(position, 1.0f);
+	return world;
+}
+
+//places every model in the map, loading each file once however many times it is used
+static void LoadLevel(Level& level, const std::string& path) {
+	std::map<std::string, ModelHandle> loaded;
+	for (const Level::MapEntry& entry : Level::ReadMap(path)) {
+		auto found = loaded.find(entry.model);
+		if (found == loaded.end())
+			found = loaded.emplace(entry.model, level.AddModel(Model::LoadObj(entry.model, true))).first;
+		level.AddObject(entry.GetTransform(), found->second);
+	}
+}
+
+//lives in memory shared by every worker
+struct Shared {
+	std::atomic<size_t> nextFrame; //handed out one at a time, so that a worker stuck on heavy frames doesn't hold the rest up
+	std::atomic<size_t> framesDone;
+};
+static_assert(std::atomic<size_t>::is_always_lock_free, "the frame counters are shared between processes");
+
+struct Options {
+	size_t frames = 100;
+	int width = 80;
+	int height = 24;
+	double fps = 30.0;
+	float far = 100.0f;
+	unsigned int jobs = 0;
+	std::string outDir;
+	std::string recordPath;
+};
+
+//renders frames until there are none left. cells, if given, holds every frame one after another for the recording
+static void Work(const Level& level, const std::vector<Key>& keys, const Options& options, Shared& shared, Video::Cell* cells) {
+	Video::InitHeadless(options.width, options.height);
+	Camera cam(glm::mat4(1.0f), keys.front().fov, 0.1f, options.far);
+	size_t frameSize = (size_t) options.width * options.height;
+	float start = keys.front().time;
+	float length = keys.back().time - start;
+
+	for (size_t frame = shared.nextFrame++; frame < options.frames; frame = shared.nextFrame++) {
+		float time = start + ((options.frames > 1) ? length * frame / (options.frames - 1) : 0.0f);
+		Key key = Sample(keys, time);
+		cam.transform.SetLocal(LookAt(key.position, key.target));
+		cam.fov = key.fov;
+
+		Video::Clear();
+		cam.BeginFrame();
+		cam.Render(level);
+		Renderer::Flush();
+
+		const std::vector<Video::Cell>& framebuffer = Video::GetFramebuffer();
+		if (cells != nullptr)
+			std::copy(framebuffer.begin(), framebuffer.end(), cells + frame * frameSize);
+
+		if (!options.outDir.empty()) {
+			char name[32];
+			snprintf(name, sizeof(name), "/frame_%05zu.txt", frame);
+			std::string path = options.outDir + name;
+			FILE* file = fopen(path.c_str(), "w");
+			if (file == nullptr)
+				throw std::runtime_error("could not write " + path);
+			std::vector<char> row(options.width + 1, '\n');
+			for (int y = 0; y < options.height; y++) {
+				for (int x = 0; x < options.width; x++)
+					row[x] = framebuffer[(size_t) y * options.width + x].ch;
+				fwrite(row.data(), 1, row.size(), file);
+			}
+			fclose(file);
+		}
+		Arena::EndFrame();
+		shared.framesDone++;
+	}
+	Video::Deinit();
+}
+
+//the workers' frames go out in order, at the times they would have had at the given rate
+static void WriteRecording(const std::string& path, const Video::Cell* cells, const Options& options) {
+	FILE* file = fopen(path.c_str(), "wb");
+	if (file == nullptr)
+		throw std::runtime_error("could not open " + path + " for writing");
+
+	FrameCodec::Encoder encoder(Recorder::KEYFRAME_INTERVAL);
+	std::vector<unsigned char> encoded;
+	FrameCodec::WriteStreamHeader(encoded);
+	size_t frameSize = (size_t) options.width * options.height;
+	for (size_t frame = 0; frame < options.frames; frame++) {
+		encoder.Encode(cells + frame * frameSize, options.width, options.height, (uint64_t) (frame * 1e6 / options.fps), encoded);
+		fwrite(encoded.data(), 1, encoded.size(), file);
+		encoded.clear();
+	}
+	fclose(file);
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		fprintf(stderr, "usage: %s <level.map> <camera.path> [--frames <n>] [--size <w>x<h>] [--fps <rate>] [--far <distance>] [--jobs <n>] [--out <directory>] [--record <recording>]\n", argv[0]);
+		return 1;
+	}
+
+	Options options;
+	for (int i = 3; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--frames") == 0)
+			options.frames = strtoul(argv[i + 1], nullptr, 10);
+		else if (strcmp(argv[i], "--size") == 0 && sscanf(argv[i + 1], "%dx%d", &options.width, &options.height) != 2)
+			options.width = 0;
+		else if (strcmp(argv[i], "--fps") == 0)
+			options.fps = atof(argv[i + 1]);
+		else if (strcmp(argv[i], "--far") == 0)
+			options.far = (float) atof(argv[i + 1]);
+		else if (strcmp(argv[i], "--jobs") == 0)
+			options.jobs = (unsigned int) strtoul(argv[i + 1], nullptr, 10);
+		else if (strcmp(argv[i], "--out") == 0)
+			options.outDir = argv[i + 1];
+		else if (strcmp(argv[i], "--record") == 0)
+			options.recordPath = argv[i + 1];
+	}
+	if (options.outDir.empty() && options.recordPath.empty()) {
+		fprintf(stderr, "nothing to write: give --out, --record or both\n");
+		return 1;
+	}
+	if (options.frames == 0 || options.width <= 0 || options.height <= 0 || options.fps <= 0.0) {
+		fprintf(stderr, "the frame count, size and rate must all be positive\n");
+		return 1;
+	}
+	if (options.jobs == 0)
+		options.jobs = std::max(1u, std::thread::hardware_concurrency());
+	options.jobs = (unsigned int) std::min((size_t) options.jobs, options.frames);
+
+	try {
+		//loaded before forking, so that every worker shares the one copy
+		Level level;
+		LoadLevel(level, argv[1]);
+		std::vector<Key> keys = ReadPath(argv[2]);
+
+		size_t cellBytes = options.recordPath.empty() ? 0 : options.frames * options.width * options.height * sizeof(Video::Cell);
+		size_t mappedBytes = sizeof(Shared) + cellBytes;
+		void* mapped = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+		if (mapped == MAP_FAILED)
+			throw std::runtime_error("could not map memory for " + std::to_string(options.frames) + " frames");
+		Shared* shared = new (mapped) Shared{{0}, {0}};
+		Video::Cell* cells = (cellBytes > 0) ? (Video::Cell*) ((char*) mapped + sizeof(Shared)) : nullptr;
+
+		std::vector<pid_t> workers;
+		for (unsigned int i = 0; i < options.jobs; i++) {
+			pid_t pid = fork();
+			if (pid < 0)
+				throw std::runtime_error("could not start a worker");
+			if (pid == 0) {
+				int status = 0;
+				try {
+					Work(level, keys, options, *shared, cells);
+				}
+				catch (const std::exception& e) {
+					fprintf(stderr, "%s\n", e.what());
+					status = 1;
+				}
+				fflush(stderr);
+				_exit(status);
+			}
+			workers.push_back(pid);
+		}
+
+		bool failed = false;
+		for (pid_t pid : workers) {
+			int status;
+			if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+				failed = true;
+		}
+		if (failed || shared->framesDone != options.frames)
+			throw std::runtime_error("a worker failed after " + std::to_string(shared->framesDone.load()) + " of " + std::to_string(options.frames) + " frames");
+
+		if (cells != nullptr)
+			WriteRecording(options.recordPath, cells, options);
+		munmap(mapped, mappedBytes);
+		printf("rendered %zu frames at %dx%d with %u workers\n", options.frames, options.width, options.height, options.jobs);
+	}
+	catch (const std::exception& e) {
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
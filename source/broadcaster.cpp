@@ -0,0 +1,123 @@
+//Nick Sells, 2024
+
+#include "broadcaster.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+extern "C" {
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+}
+
+static uint64_t Microseconds(void) {
+	return (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void SetNonBlocking(int fd) {
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+//keyframes only go out in the shared stream when the size changes. viewers that join or fall behind get their own
+Broadcaster::Broadcaster(const std::string& path):
+path(path), listener(-1), encoder(0), startTime(Microseconds()), dropped(0) {
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path))
+		throw std::runtime_error("socket path " + path + " is too long");
+	memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+	listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0)
+		throw std::runtime_error("couldn't create a socket: " + std::string(strerror(errno)));
+	unlink(path.c_str()); //left over from a run that didn't shut down properly
+	if (bind(listener, (sockaddr*) &address, sizeof(address)) != 0 || listen(listener, 8) != 0) {
+		int error = errno;
+		close(listener);
+		throw std::runtime_error("couldn't listen on " + path + ": " + strerror(error));
+	}
+	SetNonBlocking(listener);
+}
+
+Broadcaster::~Broadcaster() {
+	for (Client& client : clients)
+		close(client.fd);
+	close(listener);
+	unlink(path.c_str());
+}
+
+void Broadcaster::Accept(void) {
+	while (true) {
+		int fd = accept(listener, nullptr, nullptr);
+		if (fd < 0)
+			return;
+		SetNonBlocking(fd);
+		clients.push_back({fd, {}, 0, true, false});
+	}
+}
+
+bool Broadcaster::Flush(Client& client) {
+	while (client.sent < client.queued.size()) {
+		ssize_t result = send(client.fd, client.queued.data() + client.sent, client.queued.size() - client.sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+		if (result < 0) {
+			if (errno == EINTR)
+				continue;
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+		}
+		client.sent += (size_t) result;
+	}
+	client.queued.clear();
+	client.sent = 0;
+	return true;
+}
+
+void Broadcaster::Capture(const Video::Cell* cells, int width, int height) {
+	Accept();
+	if (clients.empty())
+		return;
+
+	//the encoder has to see every frame to keep its deltas right, even ones no viewer ends up getting
+	uint64_t time = Microseconds() - startTime;
+	delta.clear();
+	bool deltaIsKeyframe = encoder.Encode(cells, width, height, time, delta);
+	keyframe.clear();
+
+	for (size_t i = 0; i < clients.size();) {
+		Client& client = clients[i];
+		//a resyncing client waits until everything it was already sent has drained, so the keyframe doesn't pile up too
+		if (client.resync && client.queued.size() == client.sent) {
+			if (!client.joined) {
+				FrameCodec::WriteStreamHeader(client.queued);
+				client.joined = true;
+			}
+			if (deltaIsKeyframe) {
+				client.queued.insert(client.queued.end(), delta.begin(), delta.end());
+			}
+			else {
+				if (keyframe.empty())
+					FrameCodec::EncodeKeyframe(cells, width, height, time, keyframe);
+				client.queued.insert(client.queued.end(), keyframe.begin(), keyframe.end());
+			}
+			client.resync = false;
+		}
+		else if (client.resync || client.queued.size() - client.sent > MAX_QUEUED) {
+			client.resync = true;
+			dropped++;
+		}
+		else {
+			client.queued.insert(client.queued.end(), delta.begin(), delta.end());
+		}
+
+		if (Flush(client)) {
+			i++;
+		}
+		else {
+			close(client.fd);
+			clients.erase(clients.begin() + i);
+		}
+	}
+}
@@ -1,3 +0,0 @@
-//Nick Sells, 2023
-
-//static const char* GRADIENT = "$@B%8&WM#*oahkbdpqwmZO0QLCJUYXzcvunxrjft/\\|()1{}[]?-_+~<>i!lI;:,\"^`'. ";
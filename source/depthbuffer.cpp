@@ -0,0 +1,44 @@
+//Nick Sells, 2024
+
+#include "depthbuffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+void DepthBuffer::Clear(int newWidth, int newHeight) {
+	width = std::max(newWidth, 0);
+	height = std::max(newHeight, 0);
+	depth.assign((size_t) width * height, 0.0f);
+}
+
+void DepthBuffer::FillTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, int clipX, int clipY, int clipWidth, int clipHeight) {
+	//anything with a corner behind the camera has a meaningless projection
+	if (a.z <= 0.0f || b.z <= 0.0f || c.z <= 0.0f)
+		return;
+
+	float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	if (area == 0.0f || std::isnan(area))
+		return;
+	float invArea = 1.0f / area;
+
+	int minX = std::max(std::max(0, clipX), (int) std::floor(std::min(a.x, std::min(b.x, c.x))));
+	int maxX = std::min(std::min(width, clipX + clipWidth) - 1, (int) std::ceil(std::max(a.x, std::max(b.x, c.x))));
+	int minY = std::max(std::max(0, clipY), (int) std::floor(std::min(a.y, std::min(b.y, c.y))));
+	int maxY = std::min(std::min(height, clipY + clipHeight) - 1, (int) std::ceil(std::max(a.y, std::max(b.y, c.y))));
+
+	for (int y = minY; y <= maxY; y++) {
+		float py = y + 0.5f;
+		for (int x = minX; x <= maxX; x++) {
+			float px = x + 0.5f;
+			//barycentric weights; dividing by the signed area makes them positive inside for either winding
+			float w0 = ((c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x)) * invArea;
+			float w1 = ((a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x)) * invArea;
+			float w2 = 1.0f - w0 - w1;
+			if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+				continue;
+			float z = w0 * a.z + w1 * b.z + w2 * c.z;
+			float& cell = depth[(size_t) y * width + x];
+			cell = std::max(cell, z);
+		}
+	}
+}
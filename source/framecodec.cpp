@@ -0,0 +1,168 @@
+//Nick Sells, 2024
+
+#include "framecodec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+static const char MAGIC[4] = {'A', 'C', 'R', 'C'};
+
+static inline void PutInt(std::vector<unsigned char>& out, uint64_t value, int bytes) {
+	for (int i = 0; i < bytes; i++)
+		out.push_back((unsigned char) (value >> (8 * i)));
+}
+
+static inline void PatchInt(std::vector<unsigned char>& out, size_t at, uint64_t value, int bytes) {
+	for (int i = 0; i < bytes; i++)
+		out[at + i] = (unsigned char) (value >> (8 * i));
+}
+
+static inline uint64_t GetInt(const unsigned char* in, int bytes) {
+	uint64_t value = 0;
+	for (int i = 0; i < bytes; i++)
+		value |= (uint64_t) in[i] << (8 * i);
+	return value;
+}
+
+//seven bits per byte, high bit set on every byte but the last
+static inline void PutVarint(std::vector<unsigned char>& out, uint64_t value) {
+	while (value >= 0x80) {
+		out.push_back((unsigned char) (value | 0x80));
+		value >>= 7;
+	}
+	out.push_back((unsigned char) value);
+}
+
+static inline uint64_t GetVarint(const unsigned char*& in, const unsigned char* end) {
+	uint64_t value = 0;
+	for (int shift = 0; in < end && shift < 64; shift += 7) {
+		unsigned char byte = *in++;
+		value |= (uint64_t) (byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+			return value;
+	}
+	throw std::runtime_error("frame is corrupt: truncated number");
+}
+
+//writes cells [begin, end) as runs of identical cells
+static void EncodeRuns(std::vector<unsigned char>& out, const Video::Cell* cells, size_t begin, size_t end) {
+	while (begin < end) {
+		size_t run = begin + 1;
+		while (run < end && cells[run] == cells[begin])
+			run++;
+		PutVarint(out, run - begin);
+		out.push_back((unsigned char) cells[begin].ch);
+		PutVarint(out, (unsigned short) cells[begin].pairIndex);
+		begin = run;
+	}
+}
+
+//writes a frame header with a placeholder size and returns where the size goes
+static size_t BeginFrame(std::vector<unsigned char>& out, bool keyframe, uint64_t time, int width, int height) {
+	out.push_back(keyframe ? FrameCodec::KEYFRAME_FLAG : 0);
+	PutInt(out, time, 8);
+	PutInt(out, (uint64_t) width, 2);
+	PutInt(out, (uint64_t) height, 2);
+	size_t sizeAt = out.size();
+	PutInt(out, 0, 4);
+	return sizeAt;
+}
+
+static void EndFrame(std::vector<unsigned char>& out, size_t sizeAt) {
+	PatchInt(out, sizeAt, out.size() - sizeAt - 4, 4);
+}
+
+void FrameCodec::EncodeKeyframe(const Video::Cell* cells, int width, int height, uint64_t time, std::vector<unsigned char>& out) {
+	size_t n = (size_t) width * height;
+	size_t sizeAt = BeginFrame(out, true, time, width, height);
+	PutVarint(out, 0);
+	PutVarint(out, n);
+	EncodeRuns(out, cells, 0, n);
+	EndFrame(out, sizeAt);
+}
+
+bool FrameCodec::Encoder::Encode(const Video::Cell* cells, int newWidth, int newHeight, uint64_t time, std::vector<unsigned char>& out) {
+	bool resized = newWidth != width || newHeight != height;
+	bool keyframe = resized || (keyframeInterval != 0 && frameCount % keyframeInterval == 0);
+	size_t n = (size_t) newWidth * newHeight;
+	width = newWidth;
+	height = newHeight;
+	frameCount++;
+
+	if (keyframe) {
+		EncodeKeyframe(cells, width, height, time, out);
+		previous.assign(cells, cells + n);
+		return true;
+	}
+
+	size_t sizeAt = BeginFrame(out, false, time, width, height);
+	size_t spanEnd = 0;
+	size_t pos = 0;
+	while (true) {
+		while (pos < n && cells[pos] == previous[pos])
+			pos++;
+		if (pos == n)
+			break;
+
+		//grow the span up to the last changed cell that isn't separated from the rest by a long unchanged gap
+		size_t end = pos + 1;
+		for (size_t next = end; next < n && next - end < (size_t) MERGE_GAP; next++)
+			if (!(cells[next] == previous[next]))
+				end = next + 1;
+
+		PutVarint(out, pos - spanEnd);
+		PutVarint(out, end - pos);
+		EncodeRuns(out, cells, pos, end);
+		std::copy(cells + pos, cells + end, previous.begin() + pos);
+		spanEnd = pos = end;
+	}
+	EndFrame(out, sizeAt);
+	return false;
+}
+
+void FrameCodec::WriteStreamHeader(std::vector<unsigned char>& out) {
+	out.insert(out.end(), MAGIC, MAGIC + sizeof(MAGIC));
+	out.push_back(VERSION);
+}
+
+void FrameCodec::CheckStreamHeader(const unsigned char* in) {
+	if (memcmp(in, MAGIC, sizeof(MAGIC)) != 0)
+		throw std::runtime_error("not a frame stream");
+	if (in[sizeof(MAGIC)] != VERSION)
+		throw std::runtime_error("frame stream is from an incompatible version");
+}
+
+void FrameCodec::ReadFrameHeader(const unsigned char* in, Frame& frame, uint32_t& payloadSize) {
+	frame.keyframe = (in[0] & KEYFRAME_FLAG) != 0;
+	frame.time = GetInt(in + 1, 8);
+	frame.width = (int) GetInt(in + 9, 2);
+	frame.height = (int) GetInt(in + 11, 2);
+	payloadSize = (uint32_t) GetInt(in + 13, 4);
+}
+
+void FrameCodec::Decode(const Frame& frame, const unsigned char* payload, size_t size, std::vector<Video::Cell>& cells) {
+	size_t n = (size_t) frame.width * frame.height;
+	if (frame.keyframe || cells.size() != n)
+		cells.assign(n, {' ', 0});
+
+	const unsigned char* in = payload;
+	const unsigned char* end = payload + size;
+	size_t pos = 0;
+	while (in < end) {
+		pos += GetVarint(in, end);
+		uint64_t spanLength = GetVarint(in, end);
+		if (pos + spanLength > n)
+			throw std::runtime_error("frame is corrupt: span runs off the screen");
+		size_t spanEnd = pos + spanLength;
+		while (pos < spanEnd) {
+			uint64_t run = GetVarint(in, end);
+			if (in >= end || run == 0 || pos + run > spanEnd)
+				throw std::runtime_error("frame is corrupt: bad run");
+			char ch = (char) *in++;
+			short pairIndex = (short) GetVarint(in, end);
+			std::fill(cells.begin() + pos, cells.begin() + pos + run, Video::Cell{ch, pairIndex});
+			pos += run;
+		}
+	}
+}
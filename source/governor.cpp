@@ -0,0 +1,81 @@
+//Nick Sells, 2024
+
+#include "governor.h"
+#include "overlay.h"
+
+#include <algorithm>
+
+//each step gives up a little more than the one before. the overlay goes first since it costs the most for the least,
+//then detail on the models, then hidden lines, which are expensive but change the look the most
+static const Governor::Settings LADDER[] = {
+	{1.0f, true, Overlay::MAX_DETAIL},
+	{1.0f, true, Overlay::MAX_DETAIL - 1},
+	{0.5f, true, Overlay::MAX_DETAIL - 1},
+	{0.5f, false, Overlay::MAX_DETAIL - 1},
+	{0.25f, false, Overlay::MAX_DETAIL - 1},
+	{0.25f, false, Overlay::MIN_DETAIL},
+	{0.125f, false, Overlay::MIN_DETAIL},
+};
+static const size_t LADDER_STEPS = sizeof(LADDER) / sizeof(LADDER[0]);
+
+static const char* STAGE_NAMES[Governor::STAGE_COUNT] = {"simulate", "render", "rasterize", "present"};
+
+Governor::Governor(double budget):
+budget(budget), stageTimes{}, smoothedStageTimes{}, frameTime(0.0), smoothedFrameTime(0.0), step(0),
+overFrames(0), underFrames(0), settleFrames(0) {
+	BeginFrame();
+}
+
+void Governor::BeginFrame(void) {
+	frameStart = lastMark = Clock::now();
+	std::fill(stageTimes, stageTimes + STAGE_COUNT, 0.0);
+}
+
+void Governor::Mark(Stage stage) {
+	Clock::time_point now = Clock::now();
+	stageTimes[stage] += std::chrono::duration<double, std::milli>(now - lastMark).count();
+	lastMark = now;
+}
+
+void Governor::EndFrame(void) {
+	frameTime = std::chrono::duration<double, std::milli>(lastMark - frameStart).count();
+	smoothedFrameTime += SMOOTHING * (frameTime - smoothedFrameTime);
+	for (int i = 0; i < STAGE_COUNT; i++)
+		smoothedStageTimes[i] += SMOOTHING * (stageTimes[i] - smoothedStageTimes[i]);
+
+	if (settleFrames > 0) {
+		settleFrames--;
+		return;
+	}
+
+	overFrames = (smoothedFrameTime > budget) ? overFrames + 1 : 0;
+	underFrames = (smoothedFrameTime < budget * RECOVER_FRACTION) ? underFrames + 1 : 0;
+
+	if (overFrames >= DEGRADE_FRAMES && step + 1 < LADDER_STEPS) {
+		step++;
+		overFrames = underFrames = 0;
+		settleFrames = SETTLE_FRAMES;
+	}
+	else if (underFrames >= RECOVER_FRAMES && step > 0) {
+		step--;
+		overFrames = underFrames = 0;
+		settleFrames = SETTLE_FRAMES;
+	}
+}
+
+const Governor::Settings& Governor::GetSettings(void) const {
+	return LADDER[step];
+}
+
+size_t Governor::GetStepCount(void) {
+	return LADDER_STEPS;
+}
+
+const char* Governor::GetStageName(Stage stage) {
+	return STAGE_NAMES[stage];
+}
+
+int Governor::GetIdleTime(void) const {
+	double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+	return std::max(0, (int) (budget - elapsed));
+}
@@ -0,0 +1,118 @@
+//Nick Sells, 2024
+
+#include "jobs.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static std::vector<std::thread> workers;
+static std::mutex mutex;
+static std::condition_variable wake;
+static std::condition_variable done;
+static bool running = false;
+//the thread that started the pool, which runs its share of every job as thread 0
+static std::thread::id owner;
+
+//the pool index of the calling thread, and whether it's in the middle of a chunk
+static thread_local unsigned int localThread = 0;
+static thread_local bool inJob = false;
+
+//the job currently being worked on. every worker checks in on every job, even when there are no chunks left for it,
+//so a new job is never posted while a worker could still be looking at the previous one
+static const Jobs::RangeFunc* job = nullptr;
+static size_t jobCount;
+static size_t jobGrain;
+static std::atomic<size_t> nextChunk;
+static unsigned long jobSerial = 0;
+static unsigned int pendingWorkers = 0;
+
+//claims chunks until the job runs dry
+static void RunChunks(unsigned int thread) {
+	inJob = true;
+	while (true) {
+		size_t begin = nextChunk.fetch_add(jobGrain);
+		if (begin >= jobCount)
+			break;
+		PROFILE_ZONE("Jobs chunk");
+		(*job)(begin, std::min(begin + jobGrain, jobCount), thread);
+	}
+	inJob = false;
+}
+
+static void WorkerLoop(unsigned int thread) {
+	localThread = thread;
+	unsigned long seen = 0;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		wake.wait(lock, [&] { return !running || jobSerial != seen; });
+		if (!running)
+			return;
+		seen = jobSerial;
+		lock.unlock();
+		RunChunks(thread);
+		lock.lock();
+		if (--pendingWorkers == 0)
+			done.notify_all();
+	}
+}
+
+void Jobs::Init(unsigned int threads) {
+	if (running)
+		return;
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	running = true;
+	owner = std::this_thread::get_id();
+	for (unsigned int i = 1; i < threads; i++)
+		workers.emplace_back(WorkerLoop, i);
+}
+
+void Jobs::Deinit(void) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		running = false;
+	}
+	wake.notify_all();
+	for (auto& worker : workers)
+		worker.join();
+	workers.clear();
+}
+
+unsigned int Jobs::GetThreadCount(void) {
+	return (unsigned int) workers.size() + 1;
+}
+
+void Jobs::ParallelFor(size_t count, size_t grain, const RangeFunc& func) {
+	grain = std::max<size_t>(grain, 1);
+	//a loop started from inside a job runs inline on that job's thread, since the pool is busy with the outer loop
+	if (workers.empty() || count <= grain || inJob) {
+		if (count > 0)
+			func(0, count, localThread);
+		return;
+	}
+	assert(std::this_thread::get_id() == owner && "ParallelFor called from outside the pool");
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &func;
+		jobCount = count;
+		jobGrain = grain;
+		nextChunk = 0;
+		pendingWorkers = (unsigned int) workers.size();
+		jobSerial++;
+	}
+	wake.notify_all();
+
+	RunChunks(0);
+
+	//wait for every worker to check in before the job (and func) go out of scope
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [] { return pendingWorkers == 0; });
+	job = nullptr;
+}
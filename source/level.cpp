@@ -0,0 +1,175 @@
+//Nick Sells, 2024
+
+#include "level.h"
+#include "jobs.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include <glm/ext/matrix_transform.hpp>
+
+glm::mat4 Level::MapEntry::GetTransform(void) const {
+	glm::mat4 transform = glm::translate(glm::mat4(1.0f), position);
+	transform = glm::rotate(transform, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+	transform = glm::rotate(transform, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+	transform = glm::rotate(transform, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+	return glm::scale(transform, scale);
+}
+
+std::vector<Level::MapEntry> Level::ReadMap(const std::string& path) {
+	std::ifstream file(path);
+	if (!file)
+		throw std::runtime_error("could not open " + path);
+
+	std::vector<MapEntry> entries;
+	std::string line;
+	for (int number = 1; std::getline(file, line); number++) {
+		size_t start = line.find_first_not_of(" \t\r");
+		if (start == std::string::npos || line[start] == '#')
+			continue;
+
+		char model[256];
+		MapEntry entry;
+		int parsed = sscanf(line.c_str() + start, "\"%255[^\"]\" { %f , %f , %f } { %f , %f , %f } { %f , %f , %f }", model,
+			&entry.position.x, &entry.position.y, &entry.position.z,
+			&entry.rotation.x, &entry.rotation.y, &entry.rotation.z,
+			&entry.scale.x, &entry.scale.y, &entry.scale.z);
+		if (parsed != 10)
+			throw std::runtime_error(path + ":" + std::to_string(number) + ": expected \"model\" {position} {rotation} {scale}");
+		entry.model = model;
+		entries.push_back(entry);
+	}
+	return entries;
+}
+
+ModelHandle Level::AddModel(Model&& model) {
+	models.push_back(std::move(model));
+	return (ModelHandle) (models.size() - 1);
+}
+
+void Level::ReplaceModel(ModelHandle handle, Model&& model) {
+	if (handle >= models.size())
+		throw std::runtime_error("tried to replace a model the level doesn't have");
+	models[handle] = std::move(model);
+	unsigned long version = NextVersion();
+	for (unsigned int dense = 0; dense < meshes.size(); dense++) {
+		if (meshes[dense] != handle)
+			continue;
+		versions[dense] = version;
+		UpdateBounds(dense);
+	}
+}
+
+//recomputes an object's world-space bounding sphere from its model's bounds and its transform
+void Level::UpdateBounds(unsigned int dense) {
+	const Model& model = models[meshes[dense]];
+	const glm::mat4& transform = transforms[dense];
+
+	glm::vec3 center = (model.boundsMin + model.boundsMax) * 0.5f;
+	float radius = glm::length(model.boundsMax - center);
+	float scale = 0.0f;
+	for (int i = 0; i < 3; i++)
+		scale = std::max(scale, glm::length(glm::vec3(transform[i])));
+
+	spheres[dense] = glm::vec4(glm::vec3(transform * glm::vec4(center, 1.0f)), radius * scale);
+}
+
+ObjectHandle Level::AddObject(const glm::mat4& transform, ModelHandle mesh) {
+	if (mesh >= models.size())
+		throw std::runtime_error("object refers to a model the level doesn't have");
+
+	unsigned int slot;
+	if (!freeSlots.empty()) {
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	else {
+		slot = (unsigned int) slots.size();
+		slots.push_back({0, 0});
+	}
+
+	unsigned int dense = (unsigned int) transforms.size();
+	slots[slot].dense = dense;
+	transforms.push_back(transform);
+	spheres.push_back(glm::vec4(0.0f));
+	meshes.push_back(mesh);
+	versions.push_back(NextVersion());
+	occluders.push_back(0);
+	owners.push_back(slot);
+	UpdateBounds(dense);
+
+	return {slot, slots[slot].generation};
+}
+
+void Level::RemoveObject(ObjectHandle handle) {
+	if (!IsValid(handle))
+		throw std::runtime_error("tried to remove an object that doesn't exist");
+
+	//fill the hole with the last object so the arrays stay packed
+	unsigned int dense = slots[handle.slot].dense;
+	unsigned int last = (unsigned int) transforms.size() - 1;
+	occluderCount -= occluders[dense];
+	if (dense != last) {
+		transforms[dense] = transforms[last];
+		spheres[dense] = spheres[last];
+		meshes[dense] = meshes[last];
+		versions[dense] = versions[last];
+		occluders[dense] = occluders[last];
+		owners[dense] = owners[last];
+		slots[owners[dense]].dense = dense;
+	}
+	transforms.pop_back();
+	spheres.pop_back();
+	meshes.pop_back();
+	versions.pop_back();
+	occluders.pop_back();
+	owners.pop_back();
+
+	slots[handle.slot].generation++;
+	freeSlots.push_back(handle.slot);
+}
+
+bool Level::IsValid(ObjectHandle handle) const {
+	return handle.slot < slots.size() && slots[handle.slot].generation == handle.generation;
+}
+
+void Level::SetOccluder(ObjectHandle handle, bool occluder) {
+	if (!IsValid(handle))
+		throw std::runtime_error("stale object handle");
+	unsigned char& flag = occluders[slots[handle.slot].dense];
+	occluderCount += (size_t) occluder - flag;
+	flag = occluder;
+}
+
+const glm::mat4& Level::GetTransform(ObjectHandle handle) const {
+	if (!IsValid(handle))
+		throw std::runtime_error("stale object handle");
+	return transforms[slots[handle.slot].dense];
+}
+
+void Level::SetTransform(ObjectHandle handle, const glm::mat4& transform) {
+	if (!IsValid(handle))
+		throw std::runtime_error("stale object handle");
+	unsigned int dense = slots[handle.slot].dense;
+	transforms[dense] = transform;
+	versions[dense] = NextVersion();
+	UpdateBounds(dense);
+}
+
+void Level::SetTransforms(const ObjectHandle* handles, const glm::mat4* newTransforms, size_t count) {
+	for (size_t i = 0; i < count; i++)
+		if (!IsValid(handles[i]))
+			throw std::runtime_error("stale object handle");
+
+	unsigned long version = NextVersion();
+	Jobs::ParallelFor(count, 1024, [&](size_t begin, size_t end, unsigned int) {
+		for (size_t i = begin; i < end; i++) {
+			unsigned int dense = slots[handles[i].slot].dense;
+			transforms[dense] = newTransforms[i];
+			versions[dense] = version;
+			UpdateBounds(dense);
+		}
+	});
+}
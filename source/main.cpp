@@ -2,150 +2,322 @@
 //main.cpp
 
 #include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include "animation.h"
+#include "arena.h"
+#include "assets.h"
+#include "broadcaster.h"
+#include "governor.h"
 #include "camera.h"
+#include "jobs.h"
+#include "optimize.h"
+#include "overlay.h"
+#include "palette.h"
+#include "profiler.h"
+#include "recorder.h"
+#include "renderer.h"
+#include "stats.h"
 #include <glm/ext/matrix_transform.hpp>
 
 extern "C" {
 #include <ncurses.h>
 }
 //TODO: remove this include and instead get input from a dedicated input system that hides ncurses from code that doesn't need to see it
-//TODO: also migrate UI functionality into its own system which uses ncurses too
 
 unsigned long frameCounter = 0;
 int lastInput = ERR;
+volatile sig_atomic_t running = 1;
+bool splitView = false;
+bool hiddenLinesWanted = false; //the governor may still turn hidden lines off when frames run long
 
-void ShowMatrix(const char* msg, char* infoBuffer, size_t len, int& line, glm::mat4& mat) {
-	snprintf(infoBuffer, len, msg, ' ');
-	mvaddnstr(line++, 0, infoBuffer, len);
-	for(size_t i = 0; i < 4; i++) {
-		snprintf(infoBuffer, len, "[ %.3f %.3f %.3f %.3f ]", mat[0][i], mat[1][i], mat[2][i], mat[3][i]);
-		mvaddnstr(line++, 0, infoBuffer, len);
-	}
-}
-
-void UpdateInfoBlob(Camera& cam, GameObject& gobj) {
-	const size_t infoBufferLen = 128;
-	char infoBuffer[infoBufferLen];
-	int line = 0;
+static const char* const TRACE_PATH = "trace.json";
 
-	snprintf(infoBuffer, infoBufferLen, "frame #%lu", frameCounter++);
-	mvaddnstr(line++, 0, infoBuffer, infoBufferLen);
+Overlay info;
 
-	snprintf(infoBuffer, infoBufferLen, "last input: %d", lastInput);
-	mvaddnstr(line++, 0, infoBuffer, infoBufferLen);
-
-	snprintf(infoBuffer, infoBufferLen, "WASD: move laterally");
-	mvaddnstr(line++, 0, infoBuffer, infoBufferLen);
-
-	snprintf(infoBuffer, infoBufferLen, "Q/E: move up/down");
-	mvaddnstr(line++, 0, infoBuffer, infoBufferLen);
+//lays out the info blob's fields once. the help text never changes, so it is set here and never touched again
+void SetupInfoBlob(void) {
+	info.AddField("frame");
+	info.AddField("input");
+	info.AddField("quality");
+	info.AddField("stage times");
+	info.SetText(info.AddField("help", 8, 1), "WASD: move laterally", 0);
+	info.SetText(info.GetField("help"), "Q/E: move up/down", 1);
+	info.SetText(info.GetField("help"), "left/right: turn", 2);
+	info.SetText(info.GetField("help"), "Z/X: increase/decrease FOV", 3);
+	info.SetText(info.GetField("help"), "H: toggle hidden lines", 4);
+	info.SetText(info.GetField("help"), "P: dump profiler trace", 5);
+	info.SetText(info.GetField("help"), "V: toggle top/side views", 6);
+	info.SetText(info.GetField("help"), "C: toggle depth colors", 7);
+	info.AddField("screen", 1, 1);
+	info.AddField("aspect", 1, 1);
+	info.AddField("fov", 1, 1);
+	info.AddField("colors", 1, 1);
+	info.AddField("cam transform", 5, 2);
+	info.AddField("cam view", 5, 2);
+	info.AddField("cam projection", 5, 2);
+	info.AddField("obj transform", 5, 2);
+	info.AddField("trace", 1, 1);
+	info.AddField("assets", 1, 1);
+	info.AddField("object stats", 1, 1);
+	info.AddField("primitive stats", 1, 1);
+	info.AddField("cell stats", 1, 1);
+}
 
-	snprintf(infoBuffer, infoBufferLen, "left/right: turn");
-	mvaddnstr(line++, 0, infoBuffer, infoBufferLen);
+void UpdateInfoBlob(Camera& cam, const glm::mat4& objTransform, const Assets& assets, const Governor& governor) {
+	PROFILE_ZONE("UpdateInfoBlob");
+	static const size_t frameField = info.GetField("frame");
+	static const size_t inputField = info.GetField("input");
+	static const size_t qualityField = info.GetField("quality");
+	static const size_t stageTimesField = info.GetField("stage times");
+	static const size_t screenField = info.GetField("screen");
+	static const size_t aspectField = info.GetField("aspect");
+	static const size_t fovField = info.GetField("fov");
+	static const size_t colorsField = info.GetField("colors");
+	static const size_t camTransformField = info.GetField("cam transform");
+	static const size_t camViewField = info.GetField("cam view");
+	static const size_t camProjectionField = info.GetField("cam projection");
+	static const size_t objTransformField = info.GetField("obj transform");
+	static const size_t assetsField = info.GetField("assets");
+	static const size_t objectStatsField = info.GetField("object stats");
+	static const size_t primitiveStatsField = info.GetField("primitive stats");
+	static const size_t cellStatsField = info.GetField("cell stats");
 
-	snprintf(infoBuffer, infoBufferLen, "Z/X: increase/decrease FOV");
-	mvaddnstr(line++, 0, infoBuffer, infoBufferLen);
+	info.Set(frameField, "frame #%lu", frameCounter++);
+	info.Set(inputField, "last input: %d", lastInput);
 
-	snprintf(infoBuffer, infoBufferLen, "screen dimensions: %ux%u", Video::GetScreenWidth(), Video::GetScreenHeight());
-	mvaddnstr(line++, 0, infoBuffer, infoBufferLen);
+	//the governor's numbers are from the last finished frame
+	const Governor::Settings& quality = governor.GetSettings();
+	info.Set(qualityField, "quality: step %zu/%zu, %.1f/%.0fms, lod x%.3f, hidden lines %s",
+		governor.GetStep(), Governor::GetStepCount() - 1, governor.GetSmoothedFrameTime(), governor.GetBudget(), quality.lodBias,
+		quality.hiddenLines ? "allowed" : "off");
+	info.Set(stageTimesField, "ms: %.1f simulate, %.1f render, %.1f rasterize, %.1f present",
+		governor.GetStageTime(Governor::Simulate), governor.GetStageTime(Governor::Render),
+		governor.GetStageTime(Governor::Rasterize), governor.GetStageTime(Governor::Present));
+	info.Set(screenField, "screen dimensions: %ux%u", Video::GetScreenWidth(), Video::GetScreenHeight());
+	info.Set(aspectField, "aspect ratio: %.3f", Video::GetAspectRatio());
+	info.Set(fovField, "cam fov: %.3f", cam.fov);
+	info.Set(colorsField, "colors: %s, depth cued %s from %.1f to %.1f", Palette::GetModeName(),
+		Palette::IsCueing() ? "on" : "off", Palette::GetNearest(), Palette::GetFarthest());
+	info.SetMatrix(camTransformField, "camera transform:", cam.transform.GetWorld());
+	info.SetMatrix(camViewField, "camera view:", cam.view);
+	info.SetMatrix(camProjectionField, "camera projection:", cam.projection);
+	info.SetMatrix(objTransformField, "obj transform:", objTransform);
+	if (assets.GetLastError().empty())
+		info.Set(assetsField, "assets: %zu loading", assets.GetPendingCount());
+	else
+		info.Set(assetsField, "assets: %zu loading, %s", assets.GetPendingCount(), assets.GetLastError().c_str());
 
-	snprintf(infoBuffer, infoBufferLen, "aspect ratio: %.3f", Video::GetAspectRatio());
-	mvaddnstr(line++, 0, infoBuffer, infoBufferLen);
+	//counters are from the last finished frame
+	using Stats::Get;
+	info.Set(objectStatsField, "objects: %llu drawn (%llu cached), %llu culled",
+		(unsigned long long) (Get(Stats::ObjectsSubmitted) - Get(Stats::ObjectsCulled)), (unsigned long long) Get(Stats::ObjectsReused),
+		(unsigned long long) Get(Stats::ObjectsCulled));
+	info.Set(primitiveStatsField, "verts: %llu, prims: %llu drawn, %llu clipped",
+		(unsigned long long) Get(Stats::VerticesTransformed), (unsigned long long) Get(Stats::PrimitivesDrawn), (unsigned long long) Get(Stats::PrimitivesClipped));
+	info.Set(cellStatsField, "cells: %llu written, %llu changed, %llu bytes, %llu allocs, %llu arena bytes",
+		(unsigned long long) Get(Stats::CellsWritten), (unsigned long long) Get(Stats::CellsChanged),
+		(unsigned long long) Get(Stats::BytesSent), (unsigned long long) Get(Stats::Allocations),
+		(unsigned long long) Get(Stats::ArenaBytes));
 
-	snprintf(infoBuffer, infoBufferLen, "cam fov: %.3f", cam.fov);
-	mvaddnstr(line++, 0, infoBuffer, infoBufferLen);
+	info.Composite();
+}
 
-	ShowMatrix("camera transform:", infoBuffer, infoBufferLen, line, cam.transform);
-	ShowMatrix("camera view:", infoBuffer, infoBufferLen, line, cam.view);
-	ShowMatrix("camera projection:", infoBuffer, infoBufferLen, line, cam.projection);
-	ShowMatrix("obj transform:", infoBuffer, infoBufferLen, line, gobj.transform);
+//writes the last few seconds of profiler zones out and reports how it went in the info blob
+void DumpTrace(void) {
+	static const size_t traceField = info.GetField("trace");
+#ifdef ASCIICAM_PROFILE
+	if (Profiler::DumpTrace(TRACE_PATH))
+		info.Set(traceField, "trace: wrote %s", TRACE_PATH);
+	else
+		info.Set(traceField, "trace: couldn't write %s", TRACE_PATH);
+#else
+	info.SetText(traceField, "trace: build with PROFILE=1 to record");
+#endif
 }
 
 void UseInput(Camera& cam) {
 	switch(lastInput) {
 		case ERR: break;
-		case 'w': cam.transform[3] += cam.transform[2]; break;
-		case 'a': cam.transform[3] += cam.transform[0]; break;
-		case 's': cam.transform[3] -= cam.transform[2]; break;
-		case 'd': cam.transform[3] -= cam.transform[0]; break;
-		case 'q': cam.transform[3].y -= 0.5f; break;
-		case 'e': cam.transform[3].y += 0.5f; break;
+		case 'w': cam.transform.Translate(glm::vec3(cam.transform.GetLocal()[2])); break;
+		case 'a': cam.transform.Translate(glm::vec3(cam.transform.GetLocal()[0])); break;
+		case 's': cam.transform.Translate(-glm::vec3(cam.transform.GetLocal()[2])); break;
+		case 'd': cam.transform.Translate(-glm::vec3(cam.transform.GetLocal()[0])); break;
+		case 'q': cam.transform.Translate(glm::vec3(0.0f, -0.5f, 0.0f)); break;
+		case 'e': cam.transform.Translate(glm::vec3(0.0f, 0.5f, 0.0f)); break;
 		case 'z': cam.fov -= 5.0f; break;
 		case 'x': cam.fov += 5.0f; break;
+		case 'h': hiddenLinesWanted = !hiddenLinesWanted; break;
+		case 'p': DumpTrace(); break;
+		case 'v': splitView = !splitView; break;
+		case 'c': Palette::SetEnabled(!Palette::IsCueing()); break;
 		case KEY_LEFT:
-			cam.transform = glm::rotate(cam.transform, -glm::radians(10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+			cam.transform.Rotate(-glm::radians(10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
 			break;
 		case KEY_RIGHT:
-			cam.transform = glm::rotate(cam.transform, glm::radians(10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+			cam.transform.Rotate(glm::radians(10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
 			break;
 	}
 }
 
-int main(void) {
+//in split view the main camera keeps the left half of the screen, and the top and side views share the right half
+//otherwise the main camera has the whole screen to itself
+void LayoutViews(Camera& cam, Camera& top, Camera& side) {
+	int width = (int) Video::GetScreenWidth();
+	int height = (int) Video::GetScreenHeight();
+	if (!splitView) {
+		cam.viewport = {0, 0, 0, 0};
+		return;
+	}
+	int half = width / 2;
+	cam.viewport = {0, 0, half, height};
+	top.viewport = {half + 1, 0, width - half - 1, height / 2};
+	side.viewport = {half + 1, height / 2 + 1, width - half - 1, height - height / 2 - 1};
+	Renderer::SubmitLine((float) half + 0.5f, 0.0f, (float) half + 0.5f, (float) height - 1.0f);
+	Renderer::SubmitLine((float) half + 1.0f, (float) (height / 2) + 0.5f, (float) width - 1.0f, (float) (height / 2) + 0.5f);
+}
+
+//^C ends the main loop instead of killing the process, so that logs and recordings get finished properly
+void Stop(int) {
+	running = 0;
+}
+
+int main(int argc, char** argv) {
+
+	//"--stats <path>" logs every frame's counters to a csv file, or json lines if the path ends in .json or .jsonl
+	//"--record <path>" records the session for playing back with the player
+	//"--broadcast <path>" serves the session live to viewers connecting to a unix socket at that path
+	//"--points <path>" adds a point cloud from an .xyz file, scaled to fit in the middle of the scene
+	//"--budget <ms>" sets the frame time the governor aims for, which also paces the frames. a tenth of a second by default
+	double budget = 100.0;
+	std::unique_ptr<Recorder> recorder;
+	std::unique_ptr<Broadcaster> broadcaster;
+	PointCloud cloud;
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--stats") == 0 && !Stats::OpenLog(argv[i + 1])) {
+			fprintf(stderr, "couldn't open stats log %s\n", argv[i + 1]);
+			return 1;
+		}
+		if (strcmp(argv[i], "--record") == 0)
+			recorder = std::make_unique<Recorder>(argv[i + 1]);
+		if (strcmp(argv[i], "--broadcast") == 0)
+			broadcaster = std::make_unique<Broadcaster>(argv[i + 1]);
+		if (strcmp(argv[i], "--points") == 0)
+			cloud = PointCloud::LoadXyz(argv[i + 1]);
+		if (strcmp(argv[i], "--budget") == 0)
+			budget = std::max(1.0, atof(argv[i + 1]));
+	}
+
+	//installed before ncurses starts, which then leaves it alone
+	signal(SIGINT, Stop);
 
 	Video::Init();
+	cbreak(); //leaves halfdelay mode, which would override the per-frame timeouts below
+	Video::SetRecorder(recorder.get());
+	Video::SetBroadcaster(broadcaster.get());
+	Jobs::Init();
+	SetupInfoBlob();
 
 	Camera cam(glm::vec3(0.0f, 0.0f, 5.0f), 60.0f, 0.1f, 10.0f);
+	Camera top(glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 12.0f, 0.0f)), glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f)), 45.0f, 0.1f, 30.0f);
+	Camera side(glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(12.0f, 0.0f, 0.0f)), glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f)), 45.0f, 0.1f, 30.0f);
 	
-	Model cube(
-		{{1,1,1},{1,1,-1},{1,-1,1},{1,-1,-1},{-1,1,1},{-1,1,-1},{-1,-1,1},{-1,-1,-1}},
-		{0,1, 1,3, 3,2, 2,0, 4,5, 5,7, 7,6, 6,4, 0,4, 1,5, 2,6, 3,7},
-		Model::Primitive::Lines
-	);
-
-	float sqrt2 = sqrt(2);
-	Model tetrahedron(
-		{{1,0,1},{1,0,-1},{-1,0,-1},{-1,0,1},{0,sqrt2,0},{0,-sqrt2,0}},
-		{0,1, 1,2, 2,3, 3,0, 0,4, 1,4, 2,4, 3,4, 0,5, 1,5, 2,5, 3,5},
-		Model::Primitive::Lines
-	);
-
-	GameObject gobj1(glm::vec3(-3.0f, 0.0f, 0.0f), cube);
-	GameObject gobj2(glm::vec3(3.0f, 0.0f, 0.0f), tetrahedron);
+	Model cube = Model::Cube();
+	Model tetrahedron = Model::Tetrahedron();
+
+	Optimize::Stripify(cube);
+	Optimize::Stripify(tetrahedron);
+
+	//files under data/ load in the background and reload whenever they are saved
+	Level level;
+	Assets assets;
+	ModelHandle cubeModel = level.AddModel(std::move(cube));
+	ModelHandle tetrahedronModel = level.AddModel(std::move(tetrahedron));
+	ModelHandle teapotModel = assets.LoadModel(level, "data/teapot.obj", true);
+	assets.LoadLevel(level, "data/level1.map");
+
+	ObjectHandle obj1 = level.AddObject(glm::translate(glm::mat4(1.0f), glm::vec3(-3.0f, 0.0f, 0.0f)), cubeModel);
+	ObjectHandle obj2 = level.AddObject(glm::translate(glm::mat4(1.0f), glm::vec3(3.0f, 0.0f, 0.0f)), tetrahedronModel);
+	ObjectHandle obj3 = level.AddObject(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f, 0.0f)), glm::vec3(0.5f)), teapotModel);
+	level.SetOccluder(obj3, true);
+
+	glm::vec3 cloudExtent = cloud.boundsMax - cloud.boundsMin;
+	float cloudScale = 4.0f / std::max(std::max(cloudExtent.x, cloudExtent.y), std::max(cloudExtent.z, 1e-6f));
+	glm::mat4 cloudTransform = glm::translate(glm::scale(glm::mat4(1.0f), glm::vec3(cloudScale)), -(cloud.boundsMin + cloud.boundsMax) * 0.5f);
+
+	Animation animation;
+	animation.Add(obj1, {glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 3.0f, glm::vec3(3.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 5.0f, 0.0f});
+	animation.Add(obj2, {glm::vec3(0.0f), glm::vec3(1.0f), 4.5f, glm::vec3(3.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0.2f, 0.0f});
 	float anim = 0;
+	Governor governor(budget);
+
+	while(running) {
 
-	while(true) {
+		governor.BeginFrame();
+		PROFILE_FRAME();
+		PROFILE_ZONE("frame");
 
 		Video::Clear();
+		assets.Update();
+
+		const Governor::Settings& quality = governor.GetSettings();
+		cam.lodBias = top.lodBias = side.lodBias = quality.lodBias;
+		Renderer::SetHiddenLines(hiddenLinesWanted && quality.hiddenLines);
+		info.SetDetail(quality.overlayDetail);
+
+		Renderer::SubmitLine(30.0f, 0.0f, 30.0f, 32.0f);
+
+		{
+			PROFILE_ZONE("simulate");
+			anim += glm::radians(1.0f);
+			animation.Update(level, anim);
+		}
+		governor.Mark(Governor::Simulate);
 
-		Video::PlotLine(30.0f, 0.0f, 30.0f, 32.0f, 0);
-
-		anim += glm::radians(1.0f);
-
-		gobj1.transform = glm::translate(
-			glm::rotate(
-				glm::mat4(1.0f),
-				3*anim,
-				glm::vec3(0.0f, 1.0f, 0.0f)
-			),
-			glm::vec3(
-				3.0f,
-				sin(5*anim),
-				0.0f
-			)
-		);
-
-		gobj2.transform = glm::translate(
-			glm::rotate(
-				glm::mat4(1.0f),
-				4.5f*anim,
-				glm::vec3(1.0f)
-			),
-			glm::vec3(
-				3.0f,
-				sin(0.2*anim),
-				0.0f
-			)
-		);
-
-		UpdateInfoBlob(cam, gobj1);
-		cam.Render(gobj1);
-		cam.Render(gobj2);
+		//the level is animated once above, and every view below just reads it
+		//depth colors span the main camera's clip range, whichever view they are drawn in
+		LayoutViews(cam, top, side);
+		Palette::SetDepthRange(cam.near, cam.far);
+		cam.BeginFrame();
+		UpdateInfoBlob(cam, level.GetTransform(obj1), assets, governor);
+		cam.Render(level);
+		if (splitView) {
+			top.BeginFrame();
+			top.Render(level);
+			side.BeginFrame();
+			side.Render(level);
+		}
+		if (!cloud.points.empty()) {
+			cam.Render(cloud, cloudTransform);
+			if (splitView) {
+				top.Render(cloud, cloudTransform);
+				side.Render(cloud, cloudTransform);
+			}
+		}
+		governor.Mark(Governor::Render);
+		Renderer::Flush();
+		governor.Mark(Governor::Rasterize);
 		Video::Refresh();
+		governor.Mark(Governor::Present);
+		Arena::EndFrame();
+		Stats::EndFrame();
+		governor.EndFrame();
 
+		//waits out whatever is left of the budget for a key, which shows up at the end of each frame zone, then takes
+		//every other key that queued up meanwhile, so that a slow frame delays input but never loses any
+		timeout(governor.GetIdleTime());
 		lastInput = getch();
-		UseInput(cam);
+		for (int key = lastInput; key != ERR; key = getch()) {
+			lastInput = key;
+			UseInput(cam);
+			timeout(0);
+		}
 	}
 
+	Video::SetRecorder(nullptr);
+	Video::SetBroadcaster(nullptr);
+	Jobs::Deinit();
 	Video::Deinit();
+	Stats::CloseLog();
 }
@@ -0,0 +1,131 @@
+//Nick Sells, 2024
+
+#include "model.h"
+#include "optimize.h"
+#include "simplify.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+void Model::BuildLods(size_t maxLevels, float ratio) {
+	lods.clear();
+	if (renderingPrimitive != Primitive::Triangles)
+		return;
+
+	const Model* previous = this;
+	for (size_t level = 0; level < maxLevels; level++) {
+		size_t target = (size_t) (previous->GetPrimitiveCount() * ratio);
+		if (target < Simplify::MIN_TRIANGLES)
+			break;
+		Model lod = Simplify::Decimate(*previous, target);
+		//stop once the simplifier can't make meaningful progress, usually because everything left is a boundary or would flip
+		if (lod.GetPrimitiveCount() >= previous->GetPrimitiveCount() * 0.9f)
+			break;
+		Optimize::ForCache(lod);
+		lods.push_back(std::move(lod));
+		previous = &lods.back();
+	}
+}
+
+void Model::Quantize(void) {
+	if (IsQuantized() || verts.empty())
+		return;
+
+	glm::vec3 extent = boundsMax - boundsMin;
+	quantizedVerts.resize(verts.size());
+	for (size_t i = 0; i < verts.size(); i++) {
+		unsigned short q[3];
+		for (int axis = 0; axis < 3; axis++) {
+			float t = (extent[axis] > 0.0f) ? (verts[i][axis] - boundsMin[axis]) / extent[axis] : 0.0f;
+			q[axis] = (unsigned short) std::lround(std::clamp(t, 0.0f, 1.0f) * 65535.0f);
+		}
+		quantizedVerts[i] = {q[0], q[1], q[2]};
+	}
+	//shrink_to_fit on its own isn't binding, so swap with an empty vector to actually give the memory back
+	std::vector<glm::vec3>().swap(verts);
+
+	for (auto& lod : lods)
+		lod.Quantize();
+}
+
+Model Model::Cube(void) {
+	return Model(
+		{{1,1,1},{1,1,-1},{1,-1,1},{1,-1,-1},{-1,1,1},{-1,1,-1},{-1,-1,1},{-1,-1,-1}},
+		{0,1, 1,3, 3,2, 2,0, 4,5, 5,7, 7,6, 6,4, 0,4, 1,5, 2,6, 3,7},
+		Primitive::Lines
+	);
+}
+
+Model Model::Tetrahedron(void) {
+	float sqrt2 = sqrt(2);
+	return Model(
+		{{1,0,1},{1,0,-1},{-1,0,-1},{-1,0,1},{0,sqrt2,0},{0,-sqrt2,0}},
+		{0,1, 1,2, 2,3, 3,0, 0,4, 1,4, 2,4, 3,4, 0,5, 1,5, 2,5, 3,5},
+		Primitive::Lines
+	);
+}
+
+//reads one index out of a face token such as "7", "7/2", "7//3" or "7/2/3", resolving negative (relative) indices
+static unsigned short ParseObjIndex(const std::string& token, size_t numVerts) {
+	long index = std::stol(token.substr(0, token.find('/')));
+	if (index < 0)
+		index += (long) numVerts;
+	else
+		index -= 1; //obj indices start at one
+	if (index < 0 || (size_t) index >= numVerts)
+		throw std::runtime_error("obj face references a vertex that doesn't exist");
+	return (unsigned short) index;
+}
+
+Model Model::ReadObj(const std::string& path) {
+
+	std::ifstream file(path);
+	if (!file)
+		throw std::runtime_error("could not open " + path);
+
+	std::vector<glm::vec3> verts;
+	std::vector<unsigned short> indices;
+	std::vector<unsigned short> face;
+	std::string line, keyword, token;
+
+	while (std::getline(file, line)) {
+		std::istringstream stream(line);
+		if (!(stream >> keyword))
+			continue;
+
+		if (keyword == "v") {
+			glm::vec3 v;
+			stream >> v.x >> v.y >> v.z;
+			verts.push_back(v);
+			if (verts.size() >= RESTART_INDEX)
+				throw std::runtime_error(path + " has more verts than 16-bit indices can address");
+		}
+		else if (keyword == "f") {
+			face.clear();
+			while (stream >> token)
+				face.push_back(ParseObjIndex(token, verts.size()));
+			//fan-triangulate anything with more than three corners
+			for (size_t i = 2; i < face.size(); i++) {
+				indices.push_back(face[0]);
+				indices.push_back(face[i-1]);
+				indices.push_back(face[i]);
+			}
+		}
+		//normals, texture coords, groups and materials are of no use to us
+	}
+
+	return Model(verts, indices, Primitive::Triangles);
+}
+
+Model Model::LoadObj(const std::string& path, bool quantize) {
+	Model model = ReadObj(path);
+	Optimize::ForCache(model);
+	model.BuildLods();
+	Optimize::Stripify(model);
+	for (auto& lod : model.lods)
+		Optimize::Stripify(lod);
+	if (quantize)
+		model.Quantize();
+	return model;
+}
@@ -0,0 +1,173 @@
+//Nick Sells, 2024
+
+#include "occlusion.h"
+#include "arena.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static const float FAR_AWAY = std::numeric_limits<float>::max();
+
+void OcclusionBuffer::Clear(int width, int height) {
+	if (levels.empty() || levels[0].width != width || levels[0].height != height) {
+		levels.clear();
+		int w = std::max(width, 1), h = std::max(height, 1);
+		while (true) {
+			levels.push_back({w, h, std::vector<float>((size_t) w * h)});
+			if (w == 1 && h == 1)
+				break;
+			w = (w + 1) / 2;
+			h = (h + 1) / 2;
+		}
+	}
+	for (auto& level : levels)
+		std::fill(level.depth.begin(), level.depth.end(), FAR_AWAY);
+	empty = true;
+}
+
+//takes screen-space x and y and view-space depth in z. covers the cells whose centers lie inside the triangle
+void OcclusionBuffer::RasterizeTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+	Level& base = levels[0];
+	float depth = std::max(a.z, std::max(b.z, c.z));
+
+	float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	if (area == 0.0f)
+		return;
+	//accept either winding, since we don't know which way the model faces
+	float sign = (area > 0.0f) ? 1.0f : -1.0f;
+
+	int minX = std::max(0, (int) std::floor(std::min(a.x, std::min(b.x, c.x))));
+	int maxX = std::min(base.width - 1, (int) std::ceil(std::max(a.x, std::max(b.x, c.x))));
+	int minY = std::max(0, (int) std::floor(std::min(a.y, std::min(b.y, c.y))));
+	int maxY = std::min(base.height - 1, (int) std::ceil(std::max(a.y, std::max(b.y, c.y))));
+
+	for (int y = minY; y <= maxY; y++) {
+		float py = y + 0.5f;
+		for (int x = minX; x <= maxX; x++) {
+			float px = x + 0.5f;
+			float e0 = sign * ((b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x));
+			float e1 = sign * ((c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x));
+			float e2 = sign * ((a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x));
+			if (e0 < 0.0f || e1 < 0.0f || e2 < 0.0f)
+				continue;
+			float& texel = base.depth[(size_t) y * base.width + x];
+			texel = std::min(texel, depth);
+		}
+	}
+	empty = false;
+}
+
+void OcclusionBuffer::AddOccluder(const Model& model, const glm::mat4& PVM, float near) {
+	if (levels.empty())
+		return;
+
+	const Level& base = levels[0];
+	Arena::Vector<glm::vec4> screen(model.GetVertexCount());
+	for (size_t i = 0; i < screen.size(); i++) {
+		glm::vec4 clip = PVM * glm::vec4(model.GetVertex(i), 1.0f);
+		//w is the view-space depth. anything at or behind the near plane is flagged so its triangles get skipped
+		if (clip.w <= near) {
+			screen[i] = glm::vec4(0.0f, 0.0f, -1.0f, 0.0f);
+			continue;
+		}
+		screen[i].x = (clip.x / clip.w + 1.0f) * 0.5f * base.width;
+		screen[i].y = (1.0f - clip.y / clip.w) * 0.5f * base.height;
+		screen[i].z = clip.w;
+	}
+
+	auto triangle = [&](unsigned short i0, unsigned short i1, unsigned short i2) {
+		const glm::vec4& a = screen[i0];
+		const glm::vec4& b = screen[i1];
+		const glm::vec4& c = screen[i2];
+		if (a.z < 0.0f || b.z < 0.0f || c.z < 0.0f)
+			return;
+		RasterizeTriangle(a, b, c);
+	};
+
+	const auto& indices = model.indices;
+	size_t n = indices.size();
+	switch (model.renderingPrimitive) {
+		case Model::Primitive::Triangles:
+			for (size_t i = 0; i + 2 < n; i += 3)
+				triangle(indices[i], indices[i+1], indices[i+2]);
+			break;
+		case Model::Primitive::Quads:
+			for (size_t i = 0; i + 3 < n; i += 4) {
+				triangle(indices[i], indices[i+1], indices[i+2]);
+				triangle(indices[i], indices[i+2], indices[i+3]);
+			}
+			break;
+		case Model::Primitive::TriangleStrip:
+			for (size_t i = 0; i + 2 < n; i++) {
+				if (indices[i] == Model::RESTART_INDEX || indices[i+1] == Model::RESTART_INDEX || indices[i+2] == Model::RESTART_INDEX)
+					continue;
+				triangle(indices[i], indices[i+1], indices[i+2]);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+void OcclusionBuffer::BuildHierarchy(void) {
+	for (size_t l = 1; l < levels.size(); l++) {
+		const Level& fine = levels[l-1];
+		Level& coarse = levels[l];
+		for (int y = 0; y < coarse.height; y++) {
+			for (int x = 0; x < coarse.width; x++) {
+				//odd-sized levels have a last row or column whose second half hangs off the edge
+				int x0 = 2*x, x1 = std::min(2*x + 1, fine.width - 1);
+				int y0 = 2*y, y1 = std::min(2*y + 1, fine.height - 1);
+				float farthest = std::max(
+					std::max(fine.depth[(size_t) y0 * fine.width + x0], fine.depth[(size_t) y0 * fine.width + x1]),
+					std::max(fine.depth[(size_t) y1 * fine.width + x0], fine.depth[(size_t) y1 * fine.width + x1]));
+				coarse.depth[(size_t) y * coarse.width + x] = farthest;
+			}
+		}
+	}
+}
+
+bool OcclusionBuffer::IsOccluded(const glm::vec4& sphere, const glm::mat4& viewProjection, float near) const {
+	if (empty)
+		return false;
+
+	//project the corners of the sphere's bounding box to get a screen rectangle that certainly contains it
+	const Level& base = levels[0];
+	glm::vec3 center(sphere);
+	float radius = sphere.w;
+	float minX = FAR_AWAY, minY = FAR_AWAY, maxX = -FAR_AWAY, maxY = -FAR_AWAY;
+	float nearest = FAR_AWAY;
+	for (int corner = 0; corner < 8; corner++) {
+		glm::vec3 offset((corner & 1) ? radius : -radius, (corner & 2) ? radius : -radius, (corner & 4) ? radius : -radius);
+		glm::vec4 clip = viewProjection * glm::vec4(center + offset, 1.0f);
+		if (clip.w <= near)
+			return false;
+		float x = (clip.x / clip.w + 1.0f) * 0.5f * base.width;
+		float y = (1.0f - clip.y / clip.w) * 0.5f * base.height;
+		minX = std::min(minX, x); maxX = std::max(maxX, x);
+		minY = std::min(minY, y); maxY = std::max(maxY, y);
+		nearest = std::min(nearest, clip.w);
+	}
+
+	int x0 = std::max(0, (int) std::floor(minX));
+	int y0 = std::max(0, (int) std::floor(minY));
+	int x1 = std::min(base.width - 1, (int) std::floor(maxX));
+	int y1 = std::min(base.height - 1, (int) std::floor(maxY));
+	if (x0 > x1 || y0 > y1)
+		return false; //off screen entirely; frustum culling's business, not ours
+
+	//go up the hierarchy until the rectangle spans at most a couple of texels each way
+	size_t l = 0;
+	while (l + 1 < levels.size() && std::max(x1 - x0, y1 - y0) > 2) {
+		x0 /= 2; y0 /= 2; x1 /= 2; y1 /= 2;
+		l++;
+	}
+
+	const Level& level = levels[l];
+	for (int y = y0; y <= y1; y++)
+		for (int x = x0; x <= x1; x++)
+			if (level.depth[(size_t) y * level.width + x] >= nearest)
+				return false;
+	return true;
+}
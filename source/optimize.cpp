@@ -0,0 +1,284 @@
+//Nick Sells, 2024
+
+#include "optimize.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+
+//finds the next vertex to fan around once the current one has run out of triangles
+//first tries the verts emitted most recently, then falls back to scanning for any vertex with triangles left
+static int SkipDeadEnd(const std::vector<int>& liveTris, std::vector<unsigned short>& deadEnds, size_t& cursor) {
+	while (!deadEnds.empty()) {
+		unsigned short v = deadEnds.back();
+		deadEnds.pop_back();
+		if (liveTris[v] > 0)
+			return v;
+	}
+	while (cursor < liveTris.size()) {
+		if (liveTris[cursor] > 0)
+			return (int) cursor;
+		cursor++;
+	}
+	return -1;
+}
+
+void Optimize::ReorderTriangles(Model& model, size_t cacheSize) {
+	if (model.renderingPrimitive != Model::Primitive::Triangles)
+		return;
+
+	const auto& indices = model.indices;
+	size_t numVerts = model.verts.size();
+	size_t numTris = indices.size() / 3;
+	if (numTris == 0)
+		return;
+
+	//vertex to triangle adjacency, packed as offsets into one array
+	std::vector<int> liveTris(numVerts, 0);
+	for (unsigned short i : indices)
+		liveTris[i]++;
+	std::vector<size_t> offsets(numVerts + 1, 0);
+	for (size_t v = 0; v < numVerts; v++)
+		offsets[v+1] = offsets[v] + liveTris[v];
+	std::vector<unsigned int> adjacency(offsets[numVerts]);
+	std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+	for (size_t t = 0; t < numTris; t++)
+		for (int c = 0; c < 3; c++)
+			adjacency[fill[indices[3*t+c]]++] = (unsigned int) t;
+
+	std::vector<int> timestamps(numVerts, 0);
+	std::vector<bool> emitted(numTris, false);
+	std::vector<unsigned short> deadEnds;
+	std::vector<unsigned short> candidates;
+	std::vector<unsigned short> result;
+	result.reserve(indices.size());
+
+	int k = (int) cacheSize;
+	int time = k + 1;
+	size_t cursor = 1;
+	int fan = 0;
+
+	while (fan >= 0) {
+		candidates.clear();
+
+		//emit every remaining triangle around the fanning vertex
+		for (size_t a = offsets[fan]; a < offsets[fan+1]; a++) {
+			unsigned int t = adjacency[a];
+			if (emitted[t])
+				continue;
+			for (int c = 0; c < 3; c++) {
+				unsigned short v = indices[3*t+c];
+				result.push_back(v);
+				deadEnds.push_back(v);
+				candidates.push_back(v);
+				liveTris[v]--;
+				if (time - timestamps[v] > k)
+					timestamps[v] = time++;
+			}
+			emitted[t] = true;
+		}
+
+		//pick the candidate that is still in the cache and will stay there longest while we fan around it
+		int next = -1;
+		int best = -1;
+		for (unsigned short v : candidates) {
+			if (liveTris[v] <= 0)
+				continue;
+			int priority = 0;
+			if (time - timestamps[v] + 2 * liveTris[v] <= k)
+				priority = time - timestamps[v];
+			if (priority > best) {
+				best = priority;
+				next = v;
+			}
+		}
+		if (next == -1)
+			next = SkipDeadEnd(liveTris, deadEnds, cursor);
+		fan = next;
+	}
+
+	model.indices = std::move(result);
+}
+
+void Optimize::ReorderVertices(Model& model) {
+	std::vector<int> remap(model.verts.size(), -1);
+	std::vector<glm::vec3> verts;
+	verts.reserve(model.verts.size());
+
+	for (auto& i : model.indices) {
+		if (i == Model::RESTART_INDEX)
+			continue;
+		if (remap[i] < 0) {
+			remap[i] = (int) verts.size();
+			verts.push_back(model.verts[i]);
+		}
+		i = (unsigned short) remap[i];
+	}
+	//keep any verts no index refers to at the end, so nothing silently disappears
+	for (size_t v = 0; v < remap.size(); v++)
+		if (remap[v] < 0)
+			verts.push_back(model.verts[v]);
+
+	model.verts = std::move(verts);
+}
+
+void Optimize::ForCache(Model& model) {
+	ReorderTriangles(model);
+	ReorderVertices(model);
+}
+
+//walks unused edges greedily, starting each strip at an odd-degree vertex when there is one since those must end a strip anyway
+static std::vector<unsigned short> StripifyLines(const std::vector<unsigned short>& indices, size_t numVerts) {
+	size_t numEdges = indices.size() / 2;
+	std::vector<std::vector<unsigned int>> vertEdges(numVerts);
+	for (size_t e = 0; e < numEdges; e++) {
+		vertEdges[indices[2*e]].push_back((unsigned int) e);
+		vertEdges[indices[2*e+1]].push_back((unsigned int) e);
+	}
+
+	std::vector<bool> used(numEdges, false);
+	std::vector<size_t> remaining(numVerts);
+	for (size_t v = 0; v < numVerts; v++)
+		remaining[v] = vertEdges[v].size();
+
+	std::vector<unsigned short> result;
+	auto walk = [&](unsigned short start) {
+		if (!result.empty())
+			result.push_back(Model::RESTART_INDEX);
+		result.push_back(start);
+		unsigned short at = start;
+		while (remaining[at] > 0) {
+			for (unsigned int e : vertEdges[at]) {
+				if (used[e])
+					continue;
+				used[e] = true;
+				unsigned short other = (indices[2*e] == at) ? indices[2*e+1] : indices[2*e];
+				remaining[at]--;
+				remaining[other]--;
+				result.push_back(other);
+				at = other;
+				break;
+			}
+		}
+	};
+
+	for (size_t e = 0; e < numEdges; e++) {
+		if (used[e])
+			continue;
+		unsigned short a = indices[2*e], b = indices[2*e+1];
+		walk((remaining[b] % 2 == 1 && remaining[a] % 2 == 0) ? b : a);
+	}
+	return result;
+}
+
+//grows strips greedily across shared edges. a strip keeps its winding by alternating which directed edge the
+//next triangle must share: even triangles are (s[i], s[i+1], s[i+2]) and odd ones (s[i+1], s[i], s[i+2])
+static std::vector<unsigned short> StripifyTriangles(const std::vector<unsigned short>& indices) {
+	size_t numTris = indices.size() / 3;
+	std::unordered_map<uint32_t, std::vector<unsigned int>> directedEdges;
+	auto key = [](unsigned short from, unsigned short to) { return ((uint32_t) from << 16) | to; };
+	for (size_t t = 0; t < numTris; t++)
+		for (int c = 0; c < 3; c++)
+			directedEdges[key(indices[3*t+c], indices[3*t+(c+1)%3])].push_back((unsigned int) t);
+
+	std::vector<bool> used(numTris, false);
+
+	//finds an unused triangle containing the directed edge from->to and returns its third vertex, or -1
+	auto take = [&](unsigned short from, unsigned short to) -> int {
+		auto it = directedEdges.find(key(from, to));
+		if (it == directedEdges.end())
+			return -1;
+		for (unsigned int t : it->second) {
+			if (used[t])
+				continue;
+			used[t] = true;
+			for (int c = 0; c < 3; c++) {
+				unsigned short v = indices[3*t+c];
+				if (v != from && v != to)
+					return v;
+			}
+		}
+		return -1;
+	};
+
+	auto hasNeighbor = [&](unsigned short from, unsigned short to) {
+		auto it = directedEdges.find(key(from, to));
+		if (it == directedEdges.end())
+			return false;
+		for (unsigned int t : it->second)
+			if (!used[t])
+				return true;
+		return false;
+	};
+
+	std::vector<unsigned short> result;
+	std::vector<unsigned short> strip;
+	for (size_t t = 0; t < numTris; t++) {
+		if (used[t])
+			continue;
+		used[t] = true;
+
+		//rotate the starting triangle so that, if possible, the strip can continue past it
+		unsigned short a = indices[3*t], b = indices[3*t+1], c = indices[3*t+2];
+		for (int r = 0; r < 3 && !hasNeighbor(c, b); r++) {
+			unsigned short first = a;
+			a = b; b = c; c = first;
+		}
+
+		strip.assign({a, b, c});
+		while (true) {
+			size_t n = strip.size();
+			bool odd = ((n - 2) % 2) == 1;
+			int next = odd ? take(strip[n-1], strip[n-2]) : take(strip[n-2], strip[n-1]);
+			if (next < 0)
+				break;
+			strip.push_back((unsigned short) next);
+		}
+
+		if (!result.empty())
+			result.push_back(Model::RESTART_INDEX);
+		result.insert(result.end(), strip.begin(), strip.end());
+	}
+	return result;
+}
+
+void Optimize::Stripify(Model& model) {
+	std::vector<unsigned short> strips;
+	Model::Primitive primitive;
+
+	if (model.renderingPrimitive == Model::Primitive::Lines) {
+		strips = StripifyLines(model.indices, model.GetVertexCount());
+		primitive = Model::Primitive::LineStrip;
+	}
+	else if (model.renderingPrimitive == Model::Primitive::Triangles) {
+		strips = StripifyTriangles(model.indices);
+		primitive = Model::Primitive::TriangleStrip;
+	}
+	else return;
+
+	if (strips.size() >= model.indices.size())
+		return;
+	model.indices = std::move(strips);
+	model.renderingPrimitive = primitive;
+}
+
+float Optimize::CacheMissRatio(const Model& model, size_t cacheSize) {
+	size_t primitives = model.GetPrimitiveCount();
+	if (primitives == 0)
+		return 0.0f;
+
+	std::deque<unsigned short> cache;
+	size_t misses = 0;
+	for (unsigned short i : model.indices) {
+		if (i == Model::RESTART_INDEX)
+			continue;
+		if (std::find(cache.begin(), cache.end(), i) != cache.end())
+			continue;
+		misses++;
+		cache.push_back(i);
+		if (cache.size() > cacheSize)
+			cache.pop_front();
+	}
+	return (float) misses / primitives;
+}
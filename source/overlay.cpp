@@ -0,0 +1,56 @@
+//Nick Sells, 2024
+
+#include "overlay.h"
+#include "renderer.h"
+
+#include <stdexcept>
+
+size_t Overlay::AddField(const std::string& name, int rows, int detail) {
+	if (lookup.count(name) != 0)
+		throw std::runtime_error("overlay already has a field named " + name);
+	if (rows < 1)
+		throw std::runtime_error("overlay fields need at least one row");
+
+	size_t handle = fields.size();
+	fields.push_back({name, rows, detail, false, {}, std::vector<std::string>(rows)});
+	lookup[name] = handle;
+	return handle;
+}
+
+size_t Overlay::GetField(const std::string& name) const {
+	auto it = lookup.find(name);
+	if (it == lookup.end())
+		throw std::runtime_error("overlay has no field named " + name);
+	return it->second;
+}
+
+//constant text is kept even while the field is hidden, since it won't be set again
+void Overlay::SetText(size_t field, const char* text, int line) {
+	Field& f = fields[field];
+	if (f.lines[line] != text)
+		f.lines[line] = text;
+}
+
+void Overlay::SetMatrix(size_t field, const char* label, const glm::mat4& mat) {
+	Field& f = fields[field];
+	if (f.rows < 5)
+		throw std::runtime_error("matrix fields need five rows");
+	if (!Changed(f, &mat, sizeof(mat)))
+		return;
+
+	f.lines[0] = label;
+	for (int i = 0; i < 4; i++)
+		Format(f, i + 1, "[ %.3f %.3f %.3f %.3f ]", mat[0][i], mat[1][i], mat[2][i], mat[3][i]);
+}
+
+void Overlay::Composite() const {
+	int row = originY;
+	for (const Field& f : fields) {
+		if (f.detail > detail)
+			continue;
+		for (int i = 0; i < f.rows; i++)
+			if (!f.lines[i].empty())
+				Renderer::SubmitText(originX, row + i, f.lines[i].data(), f.lines[i].size());
+		row += f.rows;
+	}
+}
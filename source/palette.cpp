@@ -0,0 +1,161 @@
+//Nick Sells, 2024
+
+#include "palette.h"
+
+#include <cstdlib>
+#include <map>
+
+extern "C" {
+#include <ncurses.h>
+}
+
+Palette::Mode Palette::mode = Palette::Mode::None;
+bool Palette::enabled = true;
+short Palette::pairs[DEPTH_BANDS][SHADES];
+unsigned char Palette::bands[DEPTH_STEPS];
+float Palette::nearest = 0.0f;
+float Palette::farthest = 0.0f;
+float Palette::zMin = 0.0f;
+float Palette::zScale = 0.0f;
+
+struct Rgb {
+	int r, g, b;
+};
+
+//the nearest band is a warm white and the farthest a dim blue, so distance reads as both darker and cooler
+static const Rgb NEAR_COLOR = {255, 236, 200};
+static const Rgb FAR_COLOR = {48, 72, 140};
+//the dimmest shade keeps this much of the band's color, so that nothing fades into the background
+static const float MIN_INTENSITY = 0.4f;
+
+//the usual xterm values for the eight ANSI colors, black left out since it vanishes on most backgrounds
+static const Rgb ANSI_COLORS[] = {{205, 0, 0}, {0, 205, 0}, {205, 205, 0}, {0, 0, 238}, {205, 0, 205}, {0, 205, 205}, {229, 229, 229}};
+static const int ANSI_NUMBERS[] = {COLOR_RED, COLOR_GREEN, COLOR_YELLOW, COLOR_BLUE, COLOR_MAGENTA, COLOR_CYAN, COLOR_WHITE};
+static const int CUBE_LEVELS[] = {0, 95, 135, 175, 215, 255};
+
+static Rgb GetColor(int band, int shade) {
+	float t = (Palette::DEPTH_BANDS > 1) ? (float) band / (Palette::DEPTH_BANDS - 1) : 0.0f;
+	float intensity = MIN_INTENSITY + (1.0f - MIN_INTENSITY) * shade / (Palette::SHADES - 1);
+	auto mix = [&](int a, int b) { return (int) ((a + (b - a) * t) * intensity + 0.5f); };
+	return {mix(NEAR_COLOR.r, FAR_COLOR.r), mix(NEAR_COLOR.g, FAR_COLOR.g), mix(NEAR_COLOR.b, FAR_COLOR.b)};
+}
+
+static int DistanceSquared(const Rgb& a, const Rgb& b) {
+	return (a.r - b.r) * (a.r - b.r) + (a.g - b.g) * (a.g - b.g) + (a.b - b.b) * (a.b - b.b);
+}
+
+static int NearestCubeLevel(int value) {
+	int best = 0;
+	for (int i = 1; i < 6; i++)
+		if (std::abs(CUBE_LEVELS[i] - value) < std::abs(CUBE_LEVELS[best] - value))
+			best = i;
+	return best;
+}
+
+//the terminal's number for the color it can show nearest to rgb
+static int Quantize(const Rgb& rgb, Palette::Mode mode) {
+	switch (mode) {
+		case Palette::Mode::Basic: {
+			int best = 0;
+			for (int i = 1; i < (int) (sizeof(ANSI_COLORS) / sizeof(ANSI_COLORS[0])); i++)
+				if (DistanceSquared(rgb, ANSI_COLORS[i]) < DistanceSquared(rgb, ANSI_COLORS[best]))
+					best = i;
+			return ANSI_NUMBERS[best];
+		}
+		case Palette::Mode::Xterm256: {
+			//whichever is closer of the nearest color in the cube and the nearest step of the gray ramp
+			int r = NearestCubeLevel(rgb.r), g = NearestCubeLevel(rgb.g), b = NearestCubeLevel(rgb.b);
+			Rgb cube = {CUBE_LEVELS[r], CUBE_LEVELS[g], CUBE_LEVELS[b]};
+			int grayStep = std::clamp(((rgb.r + rgb.g + rgb.b) / 3 - 8 + 5) / 10, 0, 23);
+			int grayLevel = 8 + 10 * grayStep;
+			if (DistanceSquared(rgb, {grayLevel, grayLevel, grayLevel}) < DistanceSquared(rgb, cube))
+				return 232 + grayStep;
+			return 16 + 36 * r + 6 * g + b;
+		}
+		case Palette::Mode::TrueColor:
+			return (rgb.r << 16) | (rgb.g << 8) | rgb.b;
+		default:
+			return 0;
+	}
+}
+
+Palette::Mode Palette::Init() {
+	Mode detected = Mode::None;
+	if (has_colors() && COLOR_PAIRS >= FIRST_PAIR + PAIR_COUNT) {
+		if (COLORS >= 0x1000000)
+			detected = Mode::TrueColor;
+		else if (COLORS >= 256)
+			detected = Mode::Xterm256;
+		else if (COLORS >= 8)
+			detected = Mode::Basic;
+	}
+	Build(detected);
+
+	//only the first pair of each distinct color is used, so only those need defining
+	for (int band = 0; band < DEPTH_BANDS; band++) {
+		for (int shade = 0; shade < SHADES; shade++) {
+			short pair = pairs[band][shade];
+			if (pair != FIRST_PAIR + band * SHADES + shade)
+				continue;
+			//-1 keeps the terminal's own background, as the default pair does
+			init_extended_pair(pair, Quantize(GetColor(band, shade), mode), -1);
+		}
+	}
+	return mode;
+}
+
+void Palette::Build(Mode newMode) {
+	mode = newMode;
+	std::map<int, short> firstPairs; //by the terminal's color number
+	for (int band = 0; band < DEPTH_BANDS; band++) {
+		for (int shade = 0; shade < SHADES; shade++) {
+			if (mode == Mode::None) {
+				pairs[band][shade] = 0;
+				continue;
+			}
+			short pair = (short) (FIRST_PAIR + band * SHADES + shade);
+			pairs[band][shade] = firstPairs.emplace(Quantize(GetColor(band, shade), mode), pair).first->second;
+		}
+	}
+
+	//fills the depth table for the current range
+	float newNearest = nearest, newFarthest = farthest;
+	nearest = farthest = 0.0f;
+	SetDepthRange(newNearest > 0.0f ? newNearest : 0.1f, newFarthest > 0.0f ? newFarthest : 10.0f);
+}
+
+const char* Palette::GetModeName() {
+	switch (mode) {
+		case Mode::Basic: return "8 colors";
+		case Mode::Xterm256: return "256 colors";
+		case Mode::TrueColor: return "truecolor";
+		default: return "no colors";
+	}
+}
+
+//eg. ESC[0;31m, ESC[0;38;5;123m and ESC[0;38;2;255;236;200m
+size_t Palette::GetColorChangeBytes() {
+	switch (mode) {
+		case Mode::Xterm256: return 15;
+		case Mode::TrueColor: return 23;
+		default: return 10;
+	}
+}
+
+void Palette::SetDepthRange(float newNearest, float newFarthest) {
+	newNearest = std::max(newNearest, 1e-6f);
+	newFarthest = std::max(newFarthest, newNearest * 1.001f);
+	if (newNearest == nearest && newFarthest == farthest)
+		return;
+	nearest = newNearest;
+	farthest = newFarthest;
+
+	//the table is even in reciprocal depth, which is what the renderer carries, while the bands are even in depth
+	zMin = 1.0f / farthest;
+	zScale = DEPTH_STEPS / (1.0f / nearest - zMin);
+	for (int step = 0; step < DEPTH_STEPS; step++) {
+		float depth = 1.0f / (zMin + (step + 0.5f) / zScale);
+		int band = (int) ((depth - nearest) / (farthest - nearest) * DEPTH_BANDS);
+		bands[step] = (unsigned char) std::clamp(band, 0, DEPTH_BANDS - 1);
+	}
+}
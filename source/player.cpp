@@ -0,0 +1,109 @@
+//Nick Sells, 2024
+//player.cpp
+//replays a recording made with "asciicam --record <path>"
+//usage: player <recording> [--speed <factor>] [--seek <frame>]
+//a speed of zero plays as fast as the terminal keeps up. while playing, space pauses, +/- change speed and Q quits
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include "recorder.h"
+#include "video.h"
+
+extern "C" {
+#include <ncurses.h>
+}
+
+volatile sig_atomic_t running = 1;
+
+void Stop(int) {
+	running = 0;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s <recording> [--speed <factor>] [--seek <frame>]\n", argv[0]);
+		return 1;
+	}
+
+	double speed = 1.0;
+	size_t seek = 0;
+	for (int i = 2; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--speed") == 0)
+			speed = std::max(0.0, atof(argv[i + 1]));
+		else if (strcmp(argv[i], "--seek") == 0)
+			seek = strtoul(argv[i + 1], nullptr, 10);
+	}
+
+	try {
+		Playback playback(argv[1]);
+		if (playback.GetFrameCount() == 0)
+			throw std::runtime_error("the recording has no frames");
+
+		std::vector<Video::Cell> cells;
+		Playback::Frame frame;
+		size_t frameNumber = std::min(seek, playback.GetFrameCount() - 1);
+		playback.Seek(seek, cells, frame);
+
+		signal(SIGINT, Stop);
+		Video::Init();
+		nodelay(stdscr, true); //frames are paced by the clock here, not by waiting on input
+
+		//each frame is due its recorded gap after the one before, scaled by the speed
+		using Clock = std::chrono::steady_clock;
+		auto due = Clock::now();
+		bool paused = false;
+		bool finished = false;
+
+		while (running) {
+			Video::Clear();
+			Video::Blit(cells, frame.width, frame.height);
+			char status[128];
+			int len = snprintf(status, sizeof(status), "frame %zu/%zu  %.2fs  %.2fx%s", frameNumber + 1, playback.GetFrameCount(),
+				frame.time / 1e6, speed, paused ? "  paused" : (finished ? "  finished" : ""));
+			Video::PlotText(0.0f, (float) Video::GetScreenHeight() - 1.0f, status, (size_t) std::clamp(len, 0, (int) sizeof(status) - 1));
+			Video::Refresh();
+
+			switch (getch()) {
+				case 'q': running = 0; continue;
+				case ' ': paused = !paused; due = Clock::now(); break;
+				case '+': speed = (speed == 0.0) ? 1.0 : speed * 2.0; break;
+				case '-': speed = speed / 2.0; break;
+			}
+
+			//holding a frame still polls for input now and then
+			if (paused || finished) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				continue;
+			}
+
+			uint64_t previousTime = frame.time;
+			if (!playback.Next(cells, frame)) {
+				finished = true;
+				continue;
+			}
+			frameNumber++;
+
+			if (speed > 0.0) {
+				due += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::micro>((frame.time - previousTime) / speed));
+				std::this_thread::sleep_until(due);
+			}
+			else {
+				due = Clock::now();
+			}
+		}
+
+		Video::Deinit();
+	}
+	catch (const std::exception& e) {
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,174 @@
+//Nick Sells, 2024
+
+#include "pointcloud.h"
+#include "arena.h"
+#include "jobs.h"
+#include "palette.h"
+#include "profiler.h"
+#include "renderer.h"
+#include "stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+//glyphs from densest to emptiest. the final space is never used, since any cell with a point in it should show something
+static const char GRADIENT[] = "$@B%8&WM#*oahkbdpqwmZO0QLCJUYXzcvunxrjft/\\|()1{}[]?-_+~<>i!lI;:,\"^`'. ";
+static const size_t GRADIENT_LEVELS = sizeof(GRADIENT) - 2;
+
+void PointCloud::UpdateBounds(void) {
+	if (points.empty()) {
+		boundsMin = boundsMax = glm::vec3(0.0f);
+		return;
+	}
+	boundsMin = boundsMax = glm::vec3(points[0][0], points[0][1], points[0][2]);
+	for (const Vector4& p : points) {
+		glm::vec3 v(p[0], p[1], p[2]);
+		boundsMin = glm::min(boundsMin, v);
+		boundsMax = glm::max(boundsMax, v);
+	}
+}
+
+//scans are often tens of millions of lines, so this reads with stdio and strtof rather than through streams
+PointCloud PointCloud::LoadXyz(const std::string& path) {
+	FILE* file = fopen(path.c_str(), "r");
+	if (file == nullptr)
+		throw std::runtime_error("could not open " + path);
+
+	PointCloud cloud;
+	char line[256];
+	while (fgets(line, sizeof(line), file) != nullptr) {
+		char* cursor = line;
+		float xyz[3];
+		int parsed = 0;
+		for (; parsed < 3; parsed++) {
+			char* end;
+			xyz[parsed] = strtof(cursor, &end);
+			if (end == cursor)
+				break;
+			cursor = end;
+		}
+		//blank lines and comments are skipped rather than treated as errors
+		if (parsed == 3)
+			cloud.points.push_back(Vector4(xyz[0], xyz[1], xyz[2], 1.0f));
+	}
+	fclose(file);
+
+	cloud.UpdateBounds();
+	return cloud;
+}
+
+void DensityBuffer::Clear(const Video::Viewport& newViewport) {
+	viewport = newViewport;
+	viewport.width = std::max(viewport.width, 0);
+	viewport.height = std::max(viewport.height, 0);
+	unsigned int threads = Jobs::GetThreadCount();
+	if (histograms.size() < threads)
+		histograms.resize(threads);
+	touched.assign(histograms.size(), 0);
+}
+
+void DensityBuffer::Splat(const PointCloud& cloud, const glm::mat4& PVM) {
+	PROFILE_ZONE("DensityBuffer::Splat");
+	size_t cells = (size_t) viewport.width * viewport.height;
+	if (cells == 0)
+		return;
+	Stats::Add(Stats::VerticesTransformed, cloud.points.size());
+
+	//fold the mapping from clip space to cells into the matrix, so that x and y come out as cells times w
+	//and each point needs only one divide and no further arithmetic before it is counted
+	float width = (float) viewport.width;
+	float height = (float) viewport.height;
+	glm::mat4 toCells(1.0f);
+	toCells[0][0] = 0.5f * width;
+	toCells[1][1] = -0.5f * height;
+	toCells[3][0] = 0.5f * width;
+	toCells[3][1] = 0.5f * height;
+	Matrix4 mat(toCells * PVM);
+
+	Jobs::ParallelFor(cloud.points.size(), GRAIN, [&](size_t begin, size_t end, unsigned int thread) {
+		std::vector<uint32_t>& histogram = histograms[thread];
+		//not every thread gets a chunk, so each clears its own histogram the first time it does
+		if (!touched[thread]) {
+			histogram.assign(cells, 0);
+			touched[thread] = 1;
+		}
+
+		Vector4 clip[BATCH];
+		for (size_t batch = begin; batch < end; batch += BATCH) {
+			size_t count = std::min(BATCH, end - batch);
+			Matrix4::Transform(mat, cloud.points.data() + batch, clip, count);
+			for (size_t i = 0; i < count; i++) {
+				float w = clip[i][3];
+				float x = clip[i][0];
+				float y = clip[i][1];
+				//inside the clip volume; this also throws out anything behind the camera, where w is negative
+				if (!(x >= 0.0f && x < width * w && y >= 0.0f && y < height * w && std::abs(clip[i][2]) < w))
+					continue;
+				float invW = 1.0f / w;
+				int cx = std::min((int) (x * invW), viewport.width - 1);
+				int cy = std::min((int) (y * invW), viewport.height - 1);
+				histogram[(size_t) cy * viewport.width + cx]++;
+			}
+		}
+	});
+}
+
+void DensityBuffer::Submit(float z) {
+	PROFILE_ZONE("DensityBuffer::Submit");
+	size_t cells = (size_t) viewport.width * viewport.height;
+	density.assign(cells, 0);
+	if (cells == 0)
+		return;
+
+	//sum the histograms the threads actually used, splitting the screen between the threads
+	Arena::Vector<const uint32_t*> used;
+	for (size_t t = 0; t < histograms.size(); t++)
+		if (touched[t])
+			used.push_back(histograms[t].data());
+	if (used.empty())
+		return;
+	Jobs::ParallelFor(cells, 4096, [&](size_t begin, size_t end, unsigned int) {
+		for (const uint32_t* histogram : used)
+			for (size_t i = begin; i < end; i++)
+				density[i] += histogram[i];
+	});
+
+	uint32_t densest = *std::max_element(density.begin(), density.end());
+	if (densest == 0)
+		return;
+	float scale = (float) (GRADIENT_LEVELS - 1) / std::log1p((float) densest);
+
+	//the glyph levels split evenly between the palette's shades. without cueing every shade is the default pair
+	short pairs[Palette::SHADES] = {};
+	if (Palette::IsCueing())
+		for (int shade = 0; shade < Palette::SHADES; shade++)
+			pairs[shade] = Palette::GetPair(Palette::GetDepthBand(z), shade);
+
+	//each row goes out as one text command per run of shaded cells in the same color,
+	//so empty cells leave whatever else is drawn there alone
+	for (int y = 0; y < viewport.height; y++) {
+		const uint32_t* counts = density.data() + (size_t) y * viewport.width;
+		int x = 0;
+		while (x < viewport.width) {
+			while (x < viewport.width && counts[x] == 0)
+				x++;
+			int start = x;
+			short pair = 0;
+			row.clear();
+			for (; x < viewport.width && counts[x] != 0; x++) {
+				size_t level = std::min((size_t) (std::log1p((float) counts[x]) * scale), GRADIENT_LEVELS - 1);
+				short cellPair = pairs[level * Palette::SHADES / GRADIENT_LEVELS];
+				if (!row.empty() && cellPair != pair)
+					break;
+				pair = cellPair;
+				row.push_back(GRADIENT[GRADIENT_LEVELS - 1 - level]);
+			}
+			if (!row.empty())
+				Renderer::SubmitText((float) (viewport.x + start), (float) (viewport.y + y), row.data(), row.size(), pair);
+		}
+	}
+}
@@ -0,0 +1,106 @@
+//Nick Sells, 2024
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct Event {
+	const char* name;
+	uint64_t start;
+	uint64_t end;
+};
+
+//one thread's ring. only its owner writes to it, so the write position needs no synchronization
+struct ThreadBuffer {
+	unsigned int tid;
+	size_t written = 0;
+	Event events[Profiler::EVENTS_PER_THREAD];
+};
+
+//buffers are owned here rather than by thread_local storage so that a worker's zones survive the worker
+static std::mutex registryMutex;
+static std::vector<std::unique_ptr<ThreadBuffer>> registry;
+static thread_local ThreadBuffer* localBuffer = nullptr;
+
+//whichever thread marks frames is the one labelled as the main thread in the trace
+static const ThreadBuffer* mainBuffer = nullptr;
+static uint64_t frameStarts[Profiler::MAX_FRAMES];
+static size_t frameCount = 0;
+
+static ThreadBuffer* GetLocalBuffer(void) {
+	if (localBuffer == nullptr) {
+		std::lock_guard<std::mutex> lock(registryMutex);
+		registry.push_back(std::make_unique<ThreadBuffer>());
+		localBuffer = registry.back().get();
+		localBuffer->tid = (unsigned int) registry.size();
+	}
+	return localBuffer;
+}
+
+//index of the oldest event still in a buffer
+static inline size_t OldestEvent(const ThreadBuffer& buffer) {
+	return buffer.written > Profiler::EVENTS_PER_THREAD ? buffer.written - Profiler::EVENTS_PER_THREAD : 0;
+}
+
+uint64_t Profiler::Now(void) {
+	return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::Record(const char* name, uint64_t start, uint64_t end) {
+	ThreadBuffer* buffer = GetLocalBuffer();
+	buffer->events[buffer->written % EVENTS_PER_THREAD] = {name, start, end};
+	buffer->written++;
+}
+
+void Profiler::NextFrame(void) {
+	mainBuffer = GetLocalBuffer();
+	frameStarts[frameCount % MAX_FRAMES] = Now();
+	frameCount++;
+}
+
+bool Profiler::DumpTrace(const char* path, size_t frames) {
+	FILE* file = fopen(path, "w");
+	if (file == nullptr)
+		return false;
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+
+	//anything that started before the oldest requested frame is left out. timestamps are written relative to that frame
+	//so the trace starts at zero. without any frames marked, everything still buffered goes out
+	uint64_t cutoff = 0;
+	frames = std::min(frames, std::min(frameCount, MAX_FRAMES));
+	if (frames > 0)
+		cutoff = frameStarts[(frameCount - frames) % MAX_FRAMES];
+	uint64_t origin = cutoff;
+	if (frames == 0) {
+		origin = UINT64_MAX;
+		for (const auto& buffer : registry)
+			for (size_t i = OldestEvent(*buffer); i < buffer->written; i++)
+				origin = std::min(origin, buffer->events[i % EVENTS_PER_THREAD].start);
+	}
+
+	//complete ("X") events with timestamps in microseconds, plus a name for each thread
+	fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	bool first = true;
+	for (const auto& buffer : registry) {
+		fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+			first ? "" : ",\n", buffer->tid, buffer.get() == mainBuffer ? "main" : "worker");
+		first = false;
+
+		for (size_t i = OldestEvent(*buffer); i < buffer->written; i++) {
+			const Event& event = buffer->events[i % EVENTS_PER_THREAD];
+			if (event.start < cutoff)
+				continue;
+			fprintf(file, ",\n{\"ph\":\"X\",\"name\":\"%s\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				event.name, buffer->tid, (event.start - origin) / 1000.0, (event.end - event.start) / 1000.0);
+		}
+	}
+	fprintf(file, "\n]}\n");
+
+	return fclose(file) == 0;
+}
@@ -0,0 +1,119 @@
+//Nick Sells, 2024
+
+#include "recorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+static uint64_t Microseconds(void) {
+	return (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Recorder::Recorder(const std::string& path):
+file(nullptr), encoder(KEYFRAME_INTERVAL), startTime(Microseconds()), closing(false) {
+	file = fopen(path.c_str(), "wb");
+	if (file == nullptr)
+		throw std::runtime_error("couldn't open " + path + " for recording");
+	FrameCodec::WriteStreamHeader(encoded);
+	fwrite(encoded.data(), 1, encoded.size(), file);
+	writer = std::thread(&Recorder::WriterLoop, this);
+}
+
+Recorder::~Recorder() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		closing = true;
+	}
+	wake.notify_all();
+	writer.join();
+	fclose(file);
+}
+
+void Recorder::WriterLoop(void) {
+	std::vector<unsigned char> writing;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		wake.wait(lock, [this] { return closing || !pending.empty(); });
+		if (pending.empty())
+			return; //only reachable when closing, and there's nothing left to write
+		writing.swap(pending);
+		lock.unlock();
+		fwrite(writing.data(), 1, writing.size(), file);
+		writing.clear();
+		lock.lock();
+	}
+}
+
+void Recorder::Capture(const Video::Cell* cells, int width, int height) {
+	encoded.clear();
+	encoder.Encode(cells, width, height, Microseconds() - startTime, encoded);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.insert(pending.end(), encoded.begin(), encoded.end());
+	}
+	wake.notify_one();
+}
+
+Playback::Playback(const std::string& path):
+file(nullptr), nextFrame(0) {
+	file = fopen(path.c_str(), "rb");
+	if (file == nullptr)
+		throw std::runtime_error("couldn't open recording " + path);
+
+	unsigned char header[FrameCodec::STREAM_HEADER_SIZE];
+	try {
+		if (fread(header, 1, sizeof(header), file) != sizeof(header))
+			throw std::runtime_error("too short");
+		FrameCodec::CheckStreamHeader(header);
+	}
+	catch (const std::runtime_error& e) {
+		fclose(file);
+		throw std::runtime_error(path + " isn't a usable recording: " + e.what());
+	}
+
+	//a recording cut off mid-frame (eg. by a crash) just ends at the last whole frame
+	unsigned char frameHeader[FrameCodec::FRAME_HEADER_SIZE];
+	while (fread(frameHeader, 1, sizeof(frameHeader), file) == sizeof(frameHeader)) {
+		IndexEntry entry;
+		FrameCodec::ReadFrameHeader(frameHeader, entry.frame, entry.size);
+		entry.offset = ftell(file);
+		if (fseek(file, entry.size, SEEK_CUR) != 0)
+			break;
+		index.push_back(entry);
+	}
+	//ftell happily reports positions past the end, so check that the last payload is really there
+	fseek(file, 0, SEEK_END);
+	while (!index.empty() && index.back().offset + (long) index.back().size > ftell(file))
+		index.pop_back();
+}
+
+Playback::~Playback() {
+	fclose(file);
+}
+
+bool Playback::Next(std::vector<Video::Cell>& cells, Frame& frame) {
+	if (nextFrame >= index.size())
+		return false;
+	const IndexEntry& entry = index[nextFrame++];
+	payload.resize(entry.size);
+	fseek(file, entry.offset, SEEK_SET);
+	if (fread(payload.data(), 1, entry.size, file) != entry.size)
+		throw std::runtime_error("recording is corrupt: short frame");
+	FrameCodec::Decode(entry.frame, payload.data(), payload.size(), cells);
+	frame = entry.frame;
+	return true;
+}
+
+void Playback::Seek(size_t frameNumber, std::vector<Video::Cell>& cells, Frame& frame) {
+	if (index.empty())
+		throw std::runtime_error("can't seek in an empty recording");
+	frameNumber = std::min(frameNumber, index.size() - 1);
+	size_t keyframe = frameNumber;
+	while (keyframe > 0 && !index[keyframe].frame.keyframe)
+		keyframe--;
+	nextFrame = keyframe;
+	while (nextFrame <= frameNumber)
+		Next(cells, frame);
+}
@@ -0,0 +1,192 @@
+//Nick Sells, 2024
+
+#include "renderer.h"
+#include "arena.h"
+#include "profiler.h"
+#include "stats.h"
+#include "video.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+std::vector<Renderer::Command> Renderer::commands;
+std::string Renderer::textPool;
+std::vector<Video::Viewport> Renderer::viewports(1, {0, 0, 0, 0});
+unsigned char Renderer::currentViewport = 0;
+bool Renderer::hiddenLines = false;
+bool Renderer::depthReady = false;
+DepthBuffer Renderer::depth;
+
+//records a single point
+void Renderer::SubmitPoint(float x, float y, short pairIndex) {
+	commands.push_back({CommandType::Point, pairIndex, false, currentViewport, x, y, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0, 0});
+}
+
+//records a line between two points
+void Renderer::SubmitLine(float x0, float y0, float x1, float y1, short pairIndex) {
+	commands.push_back({CommandType::Line, pairIndex, false, currentViewport, x0, y0, 0.0f, x1, y1, 0.0f, 0.0f, 0.0f, 0.0f, 0, 0});
+}
+
+//records the outline of a triangle
+void Renderer::SubmitTriangle(float x0, float y0, float x1, float y1, float x2, float y2, short pairIndex) {
+	commands.push_back({CommandType::Triangle, pairIndex, false, currentViewport, x0, y0, 0.0f, x1, y1, 0.0f, x2, y2, 0.0f, 0, 0});
+}
+
+//records a run of text starting at the given cell. the text is copied, so the caller's buffer can be reused right away
+void Renderer::SubmitText(float x, float y, const char* text, size_t len, short pairIndex) {
+	len = strnlen(text, len);
+	unsigned int offset = (unsigned int) textPool.size();
+	textPool.append(text, len);
+	commands.push_back({CommandType::Text, pairIndex, false, currentViewport, x, y, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, offset, (unsigned int) len});
+}
+
+void Renderer::SubmitPoint(const glm::vec3& v0, short pairIndex) {
+	commands.push_back({CommandType::Point, pairIndex, true, currentViewport, v0.x, v0.y, v0.z, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0, 0});
+}
+
+void Renderer::SubmitLine(const glm::vec3& v0, const glm::vec3& v1, short pairIndex) {
+	commands.push_back({CommandType::Line, pairIndex, true, currentViewport, v0.x, v0.y, v0.z, v1.x, v1.y, v1.z, 0.0f, 0.0f, 0.0f, 0, 0});
+}
+
+void Renderer::SubmitTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, short pairIndex) {
+	commands.push_back({CommandType::Triangle, pairIndex, true, currentViewport, v0.x, v0.y, v0.z, v1.x, v1.y, v1.z, v2.x, v2.y, v2.z, 0, 0});
+}
+
+void Renderer::SubmitSurface(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2) {
+	if (!hiddenLines)
+		return;
+	if (!depthReady) {
+		depth.Clear(Video::GetScreenWidth(), Video::GetScreenHeight());
+		depthReady = true;
+	}
+	Video::Viewport clip = ResolveViewport(currentViewport);
+	depth.FillTriangle(v0, v1, v2, clip.x, clip.y, clip.width, clip.height);
+}
+
+//a frame only ever has a handful of viewports, so finding one again is a short search
+void Renderer::SetViewport(const Video::Viewport& viewport) {
+	auto found = std::find(viewports.begin() + 1, viewports.end(), viewport);
+	if (found == viewports.end()) {
+		if (viewports.size() >= MAX_VIEWPORTS)
+			throw std::runtime_error("too many viewports in one frame");
+		viewports.push_back(viewport);
+		found = viewports.end() - 1;
+	}
+	currentViewport = (unsigned char) (found - viewports.begin());
+}
+
+void Renderer::ResetViewport() {
+	currentViewport = 0;
+}
+
+Video::Viewport Renderer::ResolveViewport(unsigned char index) {
+	return (index == 0) ? Video::GetScreenViewport() : viewports[index];
+}
+
+void Renderer::SetHiddenLines(bool enabled) {
+	hiddenLines = enabled;
+}
+
+bool Renderer::GetHiddenLines() {
+	return hiddenLines;
+}
+
+//draws one command with whatever attributes are currently active
+//scene geometry goes through the depth-aware plots, which hide it behind this frame's surfaces and depth cue it
+//a point, line or triangle only counts as drawn if some of it survived clipping and the depth test. text isn't counted
+void Renderer::Execute(const Command& cmd) {
+	const DepthBuffer* test = (cmd.depthTested && depthReady) ? &depth : nullptr;
+	bool drawn = false;
+	switch (cmd.type) {
+		case CommandType::Point:
+			if (cmd.depthTested)
+				drawn = Video::PlotPixel(cmd.x0, cmd.y0, cmd.z0, test);
+			else
+				drawn = Video::PlotPixel(cmd.x0, cmd.y0);
+			break;
+		case CommandType::Line:
+			if (cmd.depthTested)
+				drawn = Video::PlotLine(cmd.x0, cmd.y0, cmd.z0, cmd.x1, cmd.y1, cmd.z1, test);
+			else
+				drawn = Video::PlotLine(cmd.x0, cmd.y0, cmd.x1, cmd.y1);
+			break;
+		case CommandType::Triangle:
+			//every edge is plotted, so no short-circuiting
+			if (cmd.depthTested) {
+				drawn = Video::PlotLine(cmd.x0, cmd.y0, cmd.z0, cmd.x1, cmd.y1, cmd.z1, test);
+				drawn |= Video::PlotLine(cmd.x1, cmd.y1, cmd.z1, cmd.x2, cmd.y2, cmd.z2, test);
+				drawn |= Video::PlotLine(cmd.x2, cmd.y2, cmd.z2, cmd.x0, cmd.y0, cmd.z0, test);
+			}
+			else {
+				drawn = Video::PlotLine(cmd.x0, cmd.y0, cmd.x1, cmd.y1);
+				drawn |= Video::PlotLine(cmd.x1, cmd.y1, cmd.x2, cmd.y2);
+				drawn |= Video::PlotLine(cmd.x2, cmd.y2, cmd.x0, cmd.y0);
+			}
+			break;
+		case CommandType::Text:
+			Video::PlotText(cmd.x0, cmd.y0, textPool.data() + cmd.textOffset, cmd.textLength);
+			break;
+	}
+	if (drawn)
+		Stats::Add(Stats::PrimitivesDrawn);
+}
+
+void Renderer::Flush() {
+	PROFILE_ZONE("Renderer::Flush");
+
+	//bucket the commands by color pair. ties keep their submission order, so that primitives sharing a pair
+	//are drawn in the order they were submitted. primitives of different pairs that overlap may swap which one wins
+	//the cell, which is the price of only switching attributes once per pair
+	//within a pair, commands are grouped by viewport too, so the clip rectangle changes as rarely as possible
+	//the sort runs over keys packing the pair, viewport and submission index together, which are far smaller than
+	//the commands, live in the frame arena and sort the same as a stable sort on the first two would
+	size_t n = commands.size();
+	Arena::Vector<uint64_t> order(n);
+	for (size_t i = 0; i < n; i++)
+		order[i] = ((uint64_t) (uint16_t) (commands[i].pairIndex + 0x8000) << 40) | ((uint64_t) commands[i].viewport << 32) | i;
+	std::sort(order.begin(), order.end());
+
+	size_t begin = 0;
+	int activeViewport = -1;
+	while (begin < n) {
+		short pairIndex = commands[(uint32_t) order[begin]].pairIndex;
+		size_t end = begin;
+		while (end < n && commands[(uint32_t) order[end]].pairIndex == pairIndex)
+			end++;
+
+		if (pairIndex != DEFAULT_PAIR) Video::BeginColor(pairIndex);
+		for (size_t i = begin; i < end; i++) {
+			const Command& cmd = commands[(uint32_t) order[i]];
+			if (cmd.viewport != activeViewport) {
+				activeViewport = cmd.viewport;
+				Video::SetViewport(ResolveViewport(activeViewport));
+			}
+			Execute(cmd);
+		}
+		if (pairIndex != DEFAULT_PAIR) Video::EndColor(pairIndex);
+
+		begin = end;
+	}
+	Video::ResetViewport();
+
+	Discard();
+}
+
+//clear() keeps the capacity around, so after the first few frames recording never touches the heap
+void Renderer::Discard() {
+	commands.clear();
+	textPool.clear();
+	viewports.resize(1);
+	currentViewport = 0;
+	depthReady = false;
+}
+
+size_t Renderer::GetCommandCount() {
+	return commands.size();
+}
+
+const std::vector<Renderer::Command>& Renderer::GetCommands() {
+	return commands;
+}
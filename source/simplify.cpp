@@ -0,0 +1,288 @@
+//Nick Sells, 2024
+
+#include "simplify.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+
+//the symmetric 4x4 matrix of the sum of squared distances to a set of planes, stored as its upper triangle
+struct Quadric {
+	double a00, a01, a02, a03;
+	double a11, a12, a13;
+	double a22, a23;
+	double a33;
+
+	inline Quadric(void):
+	a00(0), a01(0), a02(0), a03(0), a11(0), a12(0), a13(0), a22(0), a23(0), a33(0) {
+	}
+
+	//the quadric of the plane ax + by + cz + d = 0, scaled by a weight
+	inline Quadric(double a, double b, double c, double d, double w):
+	a00(w*a*a), a01(w*a*b), a02(w*a*c), a03(w*a*d),
+	a11(w*b*b), a12(w*b*c), a13(w*b*d),
+	a22(w*c*c), a23(w*c*d),
+	a33(w*d*d) {
+	}
+
+	inline Quadric& operator+=(const Quadric& o) {
+		a00 += o.a00; a01 += o.a01; a02 += o.a02; a03 += o.a03;
+		a11 += o.a11; a12 += o.a12; a13 += o.a13;
+		a22 += o.a22; a23 += o.a23;
+		a33 += o.a33;
+		return *this;
+	}
+
+	inline Quadric operator+(const Quadric& o) const {
+		Quadric result = *this;
+		result += o;
+		return result;
+	}
+
+	//the squared distance error of placing a vertex at p
+	inline double Error(const glm::vec3& p) const {
+		double x = p.x, y = p.y, z = p.z;
+		return x*x*a00 + 2*x*y*a01 + 2*x*z*a02 + 2*x*a03
+			+ y*y*a11 + 2*y*z*a12 + 2*y*a13
+			+ z*z*a22 + 2*z*a23
+			+ a33;
+	}
+
+	//finds the position that minimizes the error by solving the 3x3 system, using cramer's rule
+	//returns false when the system is close to singular (flat or linear neighborhoods)
+	inline bool Optimum(glm::vec3& result) const {
+		double det = a00*(a11*a22 - a12*a12) - a01*(a01*a22 - a12*a02) + a02*(a01*a12 - a11*a02);
+		if (std::abs(det) < 1e-12)
+			return false;
+		double bx = -a03, by = -a13, bz = -a23;
+		double dx = bx*(a11*a22 - a12*a12) - a01*(by*a22 - a12*bz) + a02*(by*a12 - a11*bz);
+		double dy = a00*(by*a22 - bz*a12) - bx*(a01*a22 - a12*a02) + a02*(a01*bz - by*a02);
+		double dz = a00*(a11*bz - a12*by) - a01*(a01*bz - by*a02) + bx*(a01*a12 - a11*a02);
+		result = glm::vec3((float) (dx / det), (float) (dy / det), (float) (dz / det));
+		return true;
+	}
+};
+
+struct Collapse {
+	double cost;
+	unsigned int u, v;
+	unsigned int versionU, versionV;
+	glm::vec3 position;
+
+	//std::priority_queue is a max-heap, so order by descending cost to pop the cheapest first
+	inline bool operator<(const Collapse& other) const {
+		return cost > other.cost;
+	}
+};
+
+static inline uint64_t EdgeKey(unsigned int a, unsigned int b) {
+	if (a > b) std::swap(a, b);
+	return ((uint64_t) a << 32) | b;
+}
+
+static inline glm::vec3 FaceNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+	return glm::cross(b - a, c - a);
+}
+
+//boundary edges get a heavy perpendicular plane so open borders (like the rim of the teapot lid) hold their shape
+static const double BOUNDARY_WEIGHT = 1000.0;
+
+class Decimator {
+
+private:
+	std::vector<glm::vec3> pos;
+	std::vector<Quadric> quadrics;
+	std::vector<std::array<unsigned int, 3>> tris;
+	std::vector<bool> triAlive;
+	std::vector<std::vector<unsigned int>> vertTris;
+	std::vector<unsigned int> versions;
+	std::vector<bool> vertAlive;
+	std::priority_queue<Collapse> heap;
+	size_t liveTris;
+
+	inline Collapse Evaluate(unsigned int u, unsigned int v) const {
+		Quadric q = quadrics[u] + quadrics[v];
+		Collapse c = {0.0, u, v, versions[u], versions[v], glm::vec3(0.0f)};
+		if (q.Optimum(c.position)) {
+			c.cost = q.Error(c.position);
+			return c;
+		}
+		//fall back to the best of the endpoints and the midpoint
+		const glm::vec3 candidates[3] = {pos[u], pos[v], (pos[u] + pos[v]) * 0.5f};
+		c.cost = std::numeric_limits<double>::max();
+		for (const auto& p : candidates) {
+			double e = q.Error(p);
+			if (e < c.cost) {
+				c.cost = e;
+				c.position = p;
+			}
+		}
+		return c;
+	}
+
+	//true if moving u and v to p would turn any surviving face around them inside out
+	inline bool Flips(unsigned int u, unsigned int v, const glm::vec3& p) const {
+		for (unsigned int moving : {u, v}) {
+			for (unsigned int f : vertTris[moving]) {
+				if (!triAlive[f])
+					continue;
+				const auto& t = tris[f];
+				bool hasU = t[0] == u || t[1] == u || t[2] == u;
+				bool hasV = t[0] == v || t[1] == v || t[2] == v;
+				if (hasU && hasV)
+					continue; //collapses away
+				glm::vec3 before[3], after[3];
+				for (int i = 0; i < 3; i++) {
+					before[i] = pos[t[i]];
+					after[i] = (t[i] == moving) ? p : pos[t[i]];
+				}
+				glm::vec3 n0 = FaceNormal(before[0], before[1], before[2]);
+				glm::vec3 n1 = FaceNormal(after[0], after[1], after[2]);
+				if (glm::dot(n0, n1) <= 0.0f)
+					return true;
+			}
+		}
+		return false;
+	}
+
+	//merges v into u at position p
+	inline void Apply(const Collapse& c) {
+		unsigned int u = c.u, v = c.v;
+		pos[u] = c.position;
+		quadrics[u] += quadrics[v];
+		for (unsigned int f : vertTris[v]) {
+			if (!triAlive[f])
+				continue;
+			auto& t = tris[f];
+			if (t[0] == u || t[1] == u || t[2] == u) {
+				triAlive[f] = false;
+				liveTris--;
+				continue;
+			}
+			for (auto& i : t)
+				if (i == v) i = u;
+			vertTris[u].push_back(f);
+		}
+		vertTris[v].clear();
+		vertAlive[v] = false;
+		versions[u]++;
+		versions[v]++;
+
+		//drop dead faces from u's list and queue fresh collapses to all of its neighbors
+		auto& faces = vertTris[u];
+		size_t kept = 0;
+		std::vector<unsigned int> neighbors;
+		for (unsigned int f : faces) {
+			if (!triAlive[f])
+				continue;
+			faces[kept++] = f;
+			for (unsigned int w : tris[f])
+				if (w != u && std::find(neighbors.begin(), neighbors.end(), w) == neighbors.end())
+					neighbors.push_back(w);
+		}
+		faces.resize(kept);
+		for (unsigned int w : neighbors)
+			heap.push(Evaluate(u, w));
+	}
+
+public:
+	inline Decimator(const Model& model):
+	pos(model.verts), quadrics(model.verts.size()), vertTris(model.verts.size()),
+	versions(model.verts.size(), 0), vertAlive(model.verts.size(), true), liveTris(0) {
+
+		const auto& indices = model.indices;
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			std::array<unsigned int, 3> t = {indices[i], indices[i+1], indices[i+2]};
+			if (t[0] == t[1] || t[1] == t[2] || t[2] == t[0])
+				continue;
+			unsigned int f = (unsigned int) tris.size();
+			tris.push_back(t);
+			triAlive.push_back(true);
+			liveTris++;
+			for (unsigned int corner : t)
+				vertTris[corner].push_back(f);
+		}
+
+		//accumulate area-weighted face planes and count how many faces share each edge
+		std::unordered_map<uint64_t, unsigned int> edgeFaces;
+		for (const auto& t : tris) {
+			glm::vec3 n = FaceNormal(pos[t[0]], pos[t[1]], pos[t[2]]);
+			float len = glm::length(n);
+			if (len > 0.0f) {
+				glm::vec3 unit = n / len;
+				Quadric q(unit.x, unit.y, unit.z, -glm::dot(unit, pos[t[0]]), 0.5 * len);
+				for (unsigned int corner : t)
+					quadrics[corner] += q;
+			}
+			for (int i = 0; i < 3; i++)
+				edgeFaces[EdgeKey(t[i], t[(i+1)%3])]++;
+		}
+
+		for (const auto& t : tris) {
+			glm::vec3 n = FaceNormal(pos[t[0]], pos[t[1]], pos[t[2]]);
+			for (int i = 0; i < 3; i++) {
+				unsigned int a = t[i], b = t[(i+1)%3];
+				if (edgeFaces[EdgeKey(a, b)] != 1)
+					continue;
+				glm::vec3 edge = pos[b] - pos[a];
+				glm::vec3 perp = glm::cross(edge, n);
+				float len = glm::length(perp);
+				if (len <= 0.0f)
+					continue;
+				perp = perp / len;
+				Quadric q(perp.x, perp.y, perp.z, -glm::dot(perp, pos[a]), BOUNDARY_WEIGHT * glm::dot(edge, edge));
+				quadrics[a] += q;
+				quadrics[b] += q;
+			}
+		}
+
+		for (const auto& entry : edgeFaces)
+			heap.push(Evaluate((unsigned int) (entry.first >> 32), (unsigned int) (entry.first & 0xffffffff)));
+	}
+
+	inline void Run(size_t targetTriangles) {
+		while (liveTris > targetTriangles && !heap.empty()) {
+			Collapse c = heap.top();
+			heap.pop();
+			if (!vertAlive[c.u] || !vertAlive[c.v])
+				continue;
+			if (versions[c.u] != c.versionU || versions[c.v] != c.versionV)
+				continue; //stale, a fresher entry for this edge was queued when a neighbor changed
+			if (Flips(c.u, c.v, c.position))
+				continue;
+			Apply(c);
+		}
+	}
+
+	//packs the surviving faces and the verts they use into a new model, keeping the verts in first-use order
+	inline Model Extract(void) const {
+		std::vector<glm::vec3> verts;
+		std::vector<unsigned short> indices;
+		std::vector<int> remap(pos.size(), -1);
+		for (size_t f = 0; f < tris.size(); f++) {
+			if (!triAlive[f])
+				continue;
+			for (unsigned int i : tris[f]) {
+				if (remap[i] < 0) {
+					remap[i] = (int) verts.size();
+					verts.push_back(pos[i]);
+				}
+				indices.push_back((unsigned short) remap[i]);
+			}
+		}
+		return Model(verts, indices, Model::Primitive::Triangles);
+	}
+};
+
+Model Simplify::Decimate(const Model& model, size_t targetTriangles) {
+	if (model.renderingPrimitive != Model::Primitive::Triangles)
+		throw std::runtime_error("can only simplify triangle meshes");
+	Decimator decimator(model);
+	decimator.Run(targetTriangles);
+	return decimator.Extract();
+}
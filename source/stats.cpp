@@ -0,0 +1,129 @@
+//Nick Sells, 2024
+
+#include "stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+//blocks are handed out from a fixed array so that registering a thread never allocates,
+//which lets the allocation counter below run on a thread that has no block yet
+static Stats::Block blocks[Stats::MAX_THREADS];
+static std::atomic<unsigned int> blockCount(0);
+thread_local Stats::Block* Stats::localBlock = nullptr;
+
+static uint64_t totals[Stats::COUNTER_COUNT];
+static unsigned long frameNumber = 0;
+
+static FILE* logFile = nullptr;
+static bool logJson = false;
+
+static const char* const NAMES[Stats::COUNTER_COUNT] = {
+	"objects_submitted",
+	"objects_culled",
+	"vertices_transformed",
+	"objects_reused",
+	"primitives_clipped",
+	"primitives_drawn",
+	"cells_written",
+	"cells_changed",
+	"bytes_sent",
+	"allocations",
+	"arena_bytes"
+};
+
+Stats::Block* Stats::RegisterThread(void) {
+	unsigned int index = blockCount.fetch_add(1);
+	localBlock = &blocks[std::min(index, MAX_THREADS - 1)];
+	return localBlock;
+}
+
+void Stats::EndFrame(void) {
+	unsigned int used = std::min(blockCount.load(), MAX_THREADS);
+	for (unsigned int c = 0; c < COUNTER_COUNT; c++) {
+		totals[c] = 0;
+		for (unsigned int b = 0; b < used; b++)
+			totals[c] += blocks[b].values[c].exchange(0, std::memory_order_relaxed);
+	}
+
+	if (logFile != nullptr) {
+		if (logJson) {
+			fprintf(logFile, "{\"frame\":%lu", frameNumber);
+			for (unsigned int c = 0; c < COUNTER_COUNT; c++)
+				fprintf(logFile, ",\"%s\":%llu", NAMES[c], (unsigned long long) totals[c]);
+			fprintf(logFile, "}\n");
+		}
+		else {
+			fprintf(logFile, "%lu", frameNumber);
+			for (unsigned int c = 0; c < COUNTER_COUNT; c++)
+				fprintf(logFile, ",%llu", (unsigned long long) totals[c]);
+			fprintf(logFile, "\n");
+		}
+		fflush(logFile); //the app is usually stopped with ^C, so nothing may be left sitting in the buffer
+	}
+	frameNumber++;
+}
+
+uint64_t Stats::Get(Counter counter) {
+	return totals[counter];
+}
+
+const char* Stats::GetName(Counter counter) {
+	return NAMES[counter];
+}
+
+bool Stats::OpenLog(const char* path) {
+	CloseLog();
+	logFile = fopen(path, "w");
+	if (logFile == nullptr)
+		return false;
+
+	size_t len = strlen(path);
+	logJson = (len >= 5 && strcmp(path + len - 5, ".json") == 0) || (len >= 6 && strcmp(path + len - 6, ".jsonl") == 0);
+	if (!logJson) {
+		fprintf(logFile, "frame");
+		for (unsigned int c = 0; c < COUNTER_COUNT; c++)
+			fprintf(logFile, ",%s", NAMES[c]);
+		fprintf(logFile, "\n");
+	}
+	return true;
+}
+
+void Stats::CloseLog(void) {
+	if (logFile != nullptr)
+		fclose(logFile);
+	logFile = nullptr;
+}
+
+//replacing the global allocation functions is the only way to see every heap allocation, including the standard library's
+//the nothrow and array forms all end up here. aligned forms are left alone, nothing in the engine uses them
+void* operator new(size_t size) {
+	Stats::Add(Stats::Allocations);
+	void* ptr = malloc(size == 0 ? 1 : size);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+	free(ptr);
+}
@@ -1,6 +1,12 @@
 //Nick Sells, 2024
 
 #include "video.h"
+#include "broadcaster.h"
+#include "depthbuffer.h"
+#include "palette.h"
+#include "profiler.h"
+#include "recorder.h"
+#include "stats.h"
 
 #include <algorithm>
 #include <cmath>
@@ -17,19 +23,33 @@ extern "C" {
 #define SECTOR_BOTTOM 0b1000
 
 bool Video::initialized;
+bool Video::headless;
 bool Video::useColor;
+int Video::width;
+int Video::height;
+short Video::currentPair;
+std::vector<Video::Cell> Video::framebuffer;
+std::vector<Video::Cell> Video::presented;
+size_t Video::cellsWritten = 0;
+Recorder* Video::recorder = nullptr;
+Broadcaster* Video::broadcaster = nullptr;
+Video::Viewport Video::viewport = {0, 0, 0, 0};
+
+//rough sizes of the escape sequences Refresh causes, for estimating the bytes sent to the terminal
+//ncurses writes straight to the terminal's descriptor, so the real count can't be observed from here
+static const size_t CURSOR_MOVE_BYTES = 8; //eg. ESC[12;34H
 
 unsigned int Video::GetSectorCode(float x, float y) {
 	
 	unsigned int result = SECTOR_CENTER;
 
-	if (x < 0.0f) //left of clip window
+	if (x < (float) viewport.x) //left of clip window
 		result |= SECTOR_LEFT;
-	else if (x > (float) COLS) //right of clip window
+	else if (x > (float) (viewport.x + viewport.width)) //right of clip window
 		result |= SECTOR_RIGHT;
-	if (y < 0.0f) //below clip window
+	if (y < (float) viewport.y) //below clip window
 		result |= SECTOR_BOTTOM;
-	else if (y > (float) LINES) //above clip window
+	else if (y > (float) (viewport.y + viewport.height)) //above clip window
 		result |= SECTOR_TOP;
 	
 	return result; 
@@ -43,6 +63,12 @@ bool Video::CohenSutherlandLineClip(float& x0, float& y0, float& x1, float& y1)
 	unsigned int sector0 = Video::GetSectorCode(x0, y0);
 	unsigned int sector1 = Video::GetSectorCode(x1, y1);
 	bool accept = false;
+	float xmin = (float) viewport.x, xmax = (float) (viewport.x + viewport.width);
+	float ymin = (float) viewport.y, ymax = (float) (viewport.y + viewport.height);
+
+	//anything not entirely on screen counts as clipped, whether it gets cut down or thrown out
+	if ((sector0 | sector1) != SECTOR_CENTER)
+		Stats::Add(Stats::PrimitivesClipped);
 
 	while (true) {
 		if ((sector0 | sector1) == SECTOR_CENTER) {
@@ -58,7 +84,7 @@ bool Video::CohenSutherlandLineClip(float& x0, float& y0, float& x1, float& y1)
 		else {
 			// failed both tests, so calculate the line segment to clip
 			// from an outside point to an intersection with clip edge
-			float x, y;
+			float x = 0.0f, y = 0.0f;
 
 			// At least one endpoint is outside the clip rectangle; pick it.
 			unsigned int outcodeOut = sector1 > sector0 ? sector1 : sector0;
@@ -71,17 +97,17 @@ bool Video::CohenSutherlandLineClip(float& x0, float& y0, float& x1, float& y1)
 			// No need to worry about divide-by-zero because, in each case, the
 			// outcode bit being tested guarantees the denominator is non-zero
 			if (outcodeOut & SECTOR_TOP) {           // point is above the clip window
-				x = x0 + (x1 - x0) * (LINES - y0) / (y1 - y0);
-				y = LINES;
+				x = x0 + (x1 - x0) * (ymax - y0) / (y1 - y0);
+				y = ymax;
 			} else if (outcodeOut & SECTOR_BOTTOM) { // point is below the clip window
-				x = x0 - (x1 - x0) * y0 / (y1 - y0);
-				y = 0;
+				x = x0 + (x1 - x0) * (ymin - y0) / (y1 - y0);
+				y = ymin;
 			} else if (outcodeOut & SECTOR_RIGHT) {  // point is to the right of clip window
-				y = y0 + (y1 - y0) * (COLS - x0) / (x1 - x0);
-				x = COLS;
+				y = y0 + (y1 - y0) * (xmax - x0) / (x1 - x0);
+				x = xmax;
 			} else if (outcodeOut & SECTOR_LEFT) {   // point is to the left of clip window
-				y = y0 - (y1 - y0) * x0 / (x1 - x0);
-				x = 0;
+				y = y0 + (y1 - y0) * (xmin - x0) / (x1 - x0);
+				x = xmin;
 			}
 
 			// Now we move outside point to intersection point to clip
@@ -100,11 +126,28 @@ bool Video::CohenSutherlandLineClip(float& x0, float& y0, float& x1, float& y1)
 	return accept;
 }
 
-unsigned int Video::GetScreenWidth() { return (unsigned int) COLS; }
-unsigned int Video::GetScreenHeight() { return (unsigned int) LINES; }
+unsigned int Video::GetScreenWidth() { return (unsigned int) width; }
+unsigned int Video::GetScreenHeight() { return (unsigned int) height; }
 float Video::GetAspectRatio() {
 	//divide by two to get closer to the real aspect ratio bc ascii makes for non-square pixels
-	return (0.5f * COLS) / LINES;
+	return (0.5f * width) / height;
+}
+
+//reallocates the framebuffer, forcing the next refresh to send every cell
+void Video::Resize(int newWidth, int newHeight) {
+	width = std::max(newWidth, 0);
+	height = std::max(newHeight, 0);
+	framebuffer.assign((size_t) width * height, {' ', 0});
+	presented.assign((size_t) width * height, {'\0', -1});
+	ResetViewport();
+}
+
+void Video::SetViewport(const Viewport& newViewport) {
+	int x0 = std::clamp(newViewport.x, 0, width);
+	int y0 = std::clamp(newViewport.y, 0, height);
+	int x1 = std::clamp(newViewport.x + newViewport.width, x0, width);
+	int y1 = std::clamp(newViewport.y + newViewport.height, y0, height);
+	viewport = {x0, y0, x1 - x0, y1 - y0};
 }
 
 //initializes the ncurses library to prepare for rendering
@@ -118,57 +161,132 @@ void Video::Init() {
 	useColor = has_colors();
 	if (useColor) {
 		start_color();
-		//TODO: set up real colors
-		init_pair(0, COLOR_RED, COLOR_BLACK);
-		init_pair(1, COLOR_GREEN, COLOR_BLACK);
-		init_pair(2, COLOR_BLUE, COLOR_BLACK);
+		use_default_colors(); //lets the palette's pairs keep the terminal's background
+		Palette::Init();
 	}
 
+	headless = false;
+	currentPair = 0;
+	Resize(COLS, LINES);
+	initialized = true;
+}
+
+void Video::InitHeadless(int w, int h) {
+	headless = true;
+	useColor = false;
+	currentPair = 0;
+	Resize(w, h);
 	initialized = true;
 }
 
 //shut down the ncurses library
 void Video::Deinit() {
 	if (!initialized) throw std::runtime_error("can only deinit if we already called init");
-	endwin();
+	if (!headless)
+		endwin();
 	initialized = false;
 }
 
-//refreshes the screen, pushing through any updates that aren't yet displayed
+//presents the framebuffer. only the cells that differ from what was presented last time are sent,
+//and the color is only switched when it differs from the previous cell sent. headless, the diff still runs but goes nowhere
 void Video::Refresh() {
 	if (!initialized) throw std::runtime_error("can only refresh if we already called init");
+	PROFILE_ZONE("Video::Refresh");
+	if (recorder != nullptr)
+		recorder->Capture(framebuffer.data(), width, height);
+	if (broadcaster != nullptr)
+		broadcaster->Capture(framebuffer.data(), width, height);
+
+	Stats::Add(Stats::CellsWritten, cellsWritten);
+	cellsWritten = 0;
+
+	short activePair = -1;
+	size_t colorChangeBytes = Palette::GetColorChangeBytes();
+	size_t changed = 0;
+	size_t bytes = 0;
+	size_t cursor = (size_t) -1; //where the terminal's cursor ends up after the last cell sent
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			size_t i = (size_t) y * width + x;
+			const Cell& cell = framebuffer[i];
+			if (cell == presented[i])
+				continue;
+			presented[i] = cell;
+			changed++;
+			if (headless)
+				continue;
+			if (useColor && cell.pairIndex != activePair) {
+				attrset(COLOR_PAIR(cell.pairIndex));
+				activePair = cell.pairIndex;
+				bytes += colorChangeBytes;
+			}
+			mvaddch(y, x, cell.ch);
+			bytes += (i == cursor ? 1 : 1 + CURSOR_MOVE_BYTES);
+			cursor = i + 1;
+		}
+	}
+	Stats::Add(Stats::CellsChanged, changed);
+	if (headless)
+		return;
+	if (useColor)
+		attrset(A_NORMAL);
 	refresh();
+	Stats::Add(Stats::BytesSent, bytes);
 }
 
-//clears the screen
+//clears the screen, picking up any change in terminal size
 void Video::Clear() {
 	if (!initialized) throw std::runtime_error("can only clear if we already called init");
-	erase();
+	if (!headless && (COLS != width || LINES != height)) {
+		Resize(COLS, LINES);
+		clear(); //the terminal's contents are unknown after a resize, so have ncurses repaint everything
+	}
+	std::fill(framebuffer.begin(), framebuffer.end(), Cell{' ', 0});
+}
+
+void Video::Blit(const std::vector<Cell>& cells, int cellsWidth, int cellsHeight) {
+	if (!initialized) throw std::runtime_error("can only blit if we already called init");
+	int w = std::min(width, cellsWidth);
+	int h = std::min(height, cellsHeight);
+	for (int y = 0; y < h; y++) {
+		auto row = cells.begin() + (size_t) y * cellsWidth;
+		std::copy(row, row + w, framebuffer.begin() + (size_t) y * width);
+	}
+	cellsWritten += (size_t) w * h;
 }
 
 //places a pixel at the specified screen corrdinates
-void Video::PlotPixel(float x, float y) {
+bool Video::PlotPixel(float x, float y) {
 	if (!initialized) throw std::runtime_error("can only plot pixels if we already called init");
-	if (std::isnan(x) || std::isnan(y)) return;
-	mvaddch(y, x, '#');
+	if (std::isnan(x) || std::isnan(y)) return false;
+	return SetCell((int) x, (int) y, '#');
 }
 
 //places a pixel at the specified screen coordinates, using the specified color
 void Video::PlotPixel(float x, float y, int pairIndex) {
-	if (useColor) attron(COLOR_PAIR(pairIndex));
+	BeginColor(pairIndex);
 	PlotPixel(x, y);
-	if (useColor) attroff(COLOR_PAIR(pairIndex));
+	EndColor(pairIndex);
+}
+
+bool Video::PlotPixel(float x, float y, float z, const DepthBuffer* depth) {
+	if (!initialized) throw std::runtime_error("can only plot pixels if we already called init");
+	if (std::isnan(x) || std::isnan(y)) return false;
+	if (depth != nullptr && !depth->Test((int) x, (int) y, z)) return false;
+	bool cue = currentPair == 0 && Palette::IsCueing();
+	return SetCell((int) x, (int) y, '#', cue ? Palette::GetDepthPair(z) : currentPair);
 }
 
 //plots out a line of pixels from one point to another, using DDA	
-void Video::PlotLine(float x0, float y0, float x1, float y1) {
+bool Video::PlotLine(float x0, float y0, float x1, float y1) {
+	PROFILE_ZONE("Video::PlotLine");
 
 	if (std::isnan(x0) || std::isnan(y0) || std::isnan(x1) || std::isnan(y1))
-		return;
+		return false;
 
 	//TODO: set up a logging system and verify that this is working
 	if (!CohenSutherlandLineClip(x0, y0, x1, y1))
-		return;
+		return false;
 
 	float x, y, step;
 	float dx = x0 - x1;
@@ -185,16 +303,92 @@ void Video::PlotLine(float x0, float y0, float x1, float y1) {
 	x = x1;
 	y = y1;
 
+	bool drawn = false;
 	while (i++ <= step) {
-		mvaddch(y,x,'#');
+		drawn |= SetCell((int) x, (int) y, '#');
 		x = x + dx;
 		y = y + dy;
 	}
+	return drawn;
 }
 
 //plots out a line of pixels from one point to another, using the specified color 
 void Video::PlotLine(float x0, float y0, float x1, float y1, int pairIndex) {
-	if (useColor) attron(COLOR_PAIR(pairIndex));
+	BeginColor(pairIndex);
 	PlotLine(x0, y0, x1, y1);
-	if (useColor) attroff(COLOR_PAIR(pairIndex));
+	EndColor(pairIndex);
+}
+
+//plots out a line like the above, but only in the cells where the line isn't behind the depth buffer's surfaces, if given
+//z is reciprocal depth, which varies linearly along the line on screen, so it can be stepped along with x and y
+//and looked up in the palette's depth table cell by cell
+bool Video::PlotLine(float x0, float y0, float z0, float x1, float y1, float z1, const DepthBuffer* depth) {
+	PROFILE_ZONE("Video::PlotLine");
+
+	if (std::isnan(x0) || std::isnan(y0) || std::isnan(x1) || std::isnan(y1))
+		return false;
+
+	//clipping moves the endpoints, so find where along the original line they ended up to recover their depths
+	float ox0 = x0, oy0 = y0, ox1 = x1, oy1 = y1;
+	if (!CohenSutherlandLineClip(x0, y0, x1, y1))
+		return false;
+	auto depthAt = [&](float x, float y) {
+		float dx = ox1 - ox0, dy = oy1 - oy0;
+		float t = (abs(dx) >= abs(dy)) ? ((dx != 0.0f) ? (x - ox0) / dx : 0.0f) : (y - oy0) / dy;
+		return z0 + (z1 - z0) * t;
+	};
+	float cz0 = depthAt(x0, y0);
+	float cz1 = depthAt(x1, y1);
+
+	float x, y, z, step;
+	float dx = x0 - x1;
+	float dy = y0 - y1;
+	float dz = cz0 - cz1;
+	int i = 0;
+
+	if (abs(dx) >= abs(dy))
+		step = abs(dx);
+	else
+		step = abs(dy);
+
+	if (step == 0.0f)
+		step = 1.0f;
+	dx /= step;
+	dy /= step;
+	dz /= step;
+	x = x1;
+	y = y1;
+	z = cz1;
+
+	bool cue = currentPair == 0 && Palette::IsCueing();
+	bool drawn = false;
+	while (i++ <= step) {
+		if (depth == nullptr || depth->Test((int) x, (int) y, z))
+			drawn |= SetCell((int) x, (int) y, '#', cue ? Palette::GetDepthPair(z) : currentPair);
+		x = x + dx;
+		y = y + dy;
+		z = z + dz;
+	}
+	return drawn;
+}
+
+//writes up to len characters of text starting at the specified screen coordinates
+void Video::PlotText(float x, float y, const char* text, size_t len) {
+	if (!initialized) throw std::runtime_error("can only plot text if we already called init");
+	if (std::isnan(x) || std::isnan(y)) return;
+	int col = (int) x, row = (int) y;
+	for (size_t i = 0; i < len && text[i] != '\0'; i++)
+		SetCell(col + (int) i, row, text[i]);
+}
+
+//turns on a color pair for everything plotted until the matching EndColor
+//callers drawing many primitives in one color should bracket the whole batch, not each primitive
+void Video::BeginColor(int pairIndex) {
+	currentPair = (short) pairIndex;
+}
+
+//turns off a color pair turned on by BeginColor
+void Video::EndColor(int pairIndex) {
+	if (currentPair == pairIndex)
+		currentPair = 0;
 }
@@ -0,0 +1,130 @@
+//Nick Sells, 2024
+//viewer.cpp
+//watches a session live, as served by "asciicam --broadcast <path>"
+//usage: viewer <socket path>
+//Q quits. the viewer exits by itself when the broadcast ends
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "framecodec.h"
+#include "video.h"
+
+extern "C" {
+#include <ncurses.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+}
+
+volatile sig_atomic_t running = 1;
+
+void Stop(int) {
+	running = 0;
+}
+
+static int Connect(const char* path) {
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(address.sun_path))
+		throw std::runtime_error("socket path " + std::string(path) + " is too long");
+	strcpy(address.sun_path, path);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || connect(fd, (sockaddr*) &address, sizeof(address)) != 0) {
+		int error = errno;
+		if (fd >= 0)
+			close(fd);
+		throw std::runtime_error("couldn't connect to " + std::string(path) + ": " + strerror(error));
+	}
+	return fd;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s <socket path>\n", argv[0]);
+		return 1;
+	}
+
+	bool videoStarted = false;
+	try {
+		int fd = Connect(argv[1]);
+
+		signal(SIGINT, Stop);
+		Video::Init();
+		videoStarted = true;
+		nodelay(stdscr, true); //waiting happens in poll instead, on the socket
+
+		std::vector<unsigned char> received; //bytes read but not yet decoded, always starting at a frame boundary
+		std::vector<Video::Cell> cells;
+		FrameCodec::Frame frame = {0, 0, 0, false};
+		bool started = false; //whether the stream header has been checked
+		bool ended = false;
+
+		while (running && !ended) {
+			pollfd waitFor = {fd, POLLIN, 0};
+			poll(&waitFor, 1, 100);
+			if (getch() == 'q')
+				break;
+			if ((waitFor.revents & (POLLIN | POLLHUP)) == 0)
+				continue;
+
+			unsigned char buffer[65536];
+			ssize_t count = read(fd, buffer, sizeof(buffer));
+			if (count <= 0) {
+				ended = count == 0 || (errno != EINTR && errno != EAGAIN);
+				continue;
+			}
+			received.insert(received.end(), buffer, buffer + count);
+
+			size_t at = 0;
+			if (!started) {
+				if (received.size() < FrameCodec::STREAM_HEADER_SIZE)
+					continue;
+				FrameCodec::CheckStreamHeader(received.data());
+				at = FrameCodec::STREAM_HEADER_SIZE;
+				started = true;
+			}
+
+			//only the newest frame is drawn, but every frame has to be decoded for the deltas to add up
+			bool decoded = false;
+			while (received.size() - at >= FrameCodec::FRAME_HEADER_SIZE) {
+				FrameCodec::Frame next;
+				uint32_t size;
+				FrameCodec::ReadFrameHeader(received.data() + at, next, size);
+				if (received.size() - at - FrameCodec::FRAME_HEADER_SIZE < size)
+					break;
+				FrameCodec::Decode(next, received.data() + at + FrameCodec::FRAME_HEADER_SIZE, size, cells);
+				frame = next;
+				at += FrameCodec::FRAME_HEADER_SIZE + size;
+				decoded = true;
+			}
+			received.erase(received.begin(), received.begin() + at);
+
+			if (decoded) {
+				Video::Clear();
+				Video::Blit(cells, frame.width, frame.height);
+				Video::Refresh();
+			}
+		}
+
+		Video::Deinit();
+		videoStarted = false;
+		close(fd);
+		if (ended)
+			printf("the broadcast has ended\n");
+	}
+	catch (const std::exception& e) {
+		//a corrupt stream shouldn't leave the terminal in curses mode
+		if (videoStarted)
+			Video::Deinit();
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,238 @@
+//Nick Sells, 2024
+//bench.cpp
+//times each stage of the pipeline on its own, over a fixed set of scenes, against a headless framebuffer
+//prints one json object per scene and stage so that results can be diffed between builds
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "arena.h"
+#include "camera.h"
+#include "jobs.h"
+#include "optimize.h"
+#include "renderer.h"
+#include "video.h"
+
+static const int SCREEN_WIDTH = 160;
+static const int SCREEN_HEIGHT = 48;
+
+//runs a stage repeatedly until it has used up its time budget and reports the median and fastest runs
+//setup runs before every iteration but isn't timed. each iteration counts as a frame for the frame arenas
+static void Measure(const char* scene, const char* stage, size_t items, const std::function<void()>& setup, const std::function<void()>& body) {
+	using Clock = std::chrono::steady_clock;
+	const auto budget = std::chrono::milliseconds(200);
+	const size_t minIterations = 5;
+
+	std::vector<double> samples;
+	auto start = Clock::now();
+	for (int i = 0; i < 2; i++) { //warm up caches and any lazily grown buffers
+		setup();
+		body();
+		Arena::EndFrame();
+	}
+	while (samples.size() < minIterations || Clock::now() - start < budget) {
+		setup();
+		auto t0 = Clock::now();
+		body();
+		auto t1 = Clock::now();
+		Arena::EndFrame();
+		samples.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count());
+	}
+
+	std::sort(samples.begin(), samples.end());
+	printf("{\"scene\":\"%s\",\"stage\":\"%s\",\"items\":%zu,\"iterations\":%zu,\"median_ns\":%.0f,\"min_ns\":%.0f}\n",
+		scene, stage, items, samples.size(), samples[samples.size() / 2], samples[0]);
+	fflush(stdout);
+}
+
+static void Nothing() {}
+
+//reports how well Tipsify orders a model for the vertex cache, as the average cache miss ratio of the file's own
+//triangle order against the reordered one, then times the reordering itself
+static void MeasureCacheOrder(const char* scene, const char* path) {
+	Model raw = Model::ReadObj(path);
+	Model sorted = raw;
+	Optimize::ReorderTriangles(sorted);
+	printf("{\"scene\":\"%s\",\"stage\":\"acmr\",\"items\":%zu,\"before\":%.3f,\"after\":%.3f}\n",
+		scene, raw.GetPrimitiveCount(), Optimize::CacheMissRatio(raw), Optimize::CacheMissRatio(sorted));
+	fflush(stdout);
+
+	Measure(scene, "tipsify", raw.GetPrimitiveCount(), [&] { sorted = raw; }, [&] { Optimize::ReorderTriangles(sorted); });
+}
+
+//benchmarks every stage after asset loading for a level seen through a camera
+static void RunScene(const char* scene, const Level& level, Camera& cam) {
+	cam.BeginFrame();
+
+	size_t numVerts = 0;
+	for (ModelHandle mesh : level.GetMeshes())
+		numVerts += level.GetModel(mesh).GetVertexCount();
+
+	//vertex transform: every object's verts all the way to screen space
+	std::vector<glm::vec3> screenVerts;
+	Measure(scene, "transform", numVerts, Nothing, [&] {
+		const auto& transforms = level.GetTransforms();
+		const auto& meshes = level.GetMeshes();
+		for (size_t i = 0; i < level.GetObjectCount(); i++) {
+			const Model& model = level.GetModel(meshes[i]);
+			size_t n = model.GetVertexCount();
+			screenVerts.resize(n);
+			glm::mat4 PVM = cam.viewProjection * transforms[i];
+			if (model.IsQuantized())
+				Camera::Project(PVM * model.GetDequantization(), model.quantizedVerts.data(), n, screenVerts.data(), cam.GetViewport());
+			else
+				Camera::Project(PVM, model.verts.data(), n, screenVerts.data(), cam.GetViewport());
+		}
+	});
+
+	//record: culling, lod selection, transform and command recording, as the app does it
+	Measure(scene, "record", level.GetObjectCount(), [&] {
+		Renderer::Discard();
+		cam.InvalidateCache();
+	}, [&] {
+		cam.Render(level);
+	});
+
+	//record again with nothing moved since the last frame, so every object comes from the camera's cache
+	Measure(scene, "record_static", level.GetObjectCount(), Renderer::Discard, [&] {
+		cam.Render(level);
+	});
+
+	//clip: every recorded edge against the screen
+	Renderer::Discard();
+	cam.Render(level);
+	std::vector<glm::vec4> edges;
+	for (const auto& cmd : Renderer::GetCommands()) {
+		if (cmd.type == Renderer::CommandType::Line)
+			edges.emplace_back(cmd.x0, cmd.y0, cmd.x1, cmd.y1);
+		else if (cmd.type == Renderer::CommandType::Triangle) {
+			edges.emplace_back(cmd.x0, cmd.y0, cmd.x1, cmd.y1);
+			edges.emplace_back(cmd.x1, cmd.y1, cmd.x2, cmd.y2);
+			edges.emplace_back(cmd.x2, cmd.y2, cmd.x0, cmd.y0);
+		}
+	}
+	size_t accepted = 0;
+	Measure(scene, "clip", edges.size(), Nothing, [&] {
+		accepted = 0;
+		for (const auto& e : edges) {
+			float x0 = e.x, y0 = e.y, x1 = e.z, y1 = e.w;
+			accepted += Video::CohenSutherlandLineClip(x0, y0, x1, y1);
+		}
+	});
+
+	//rasterize: executing the recorded commands into the framebuffer
+	size_t numCommands = Renderer::GetCommandCount();
+	Measure(scene, "rasterize", numCommands, [&] {
+		Renderer::Discard();
+		cam.Render(level);
+		Video::Clear();
+	}, Renderer::Flush);
+
+	//present: diffing the framebuffer against the previous frame. alternating between a blank frame and the scene
+	//makes every drawn cell count as changed, which is the worst case
+	Measure(scene, "present", (size_t) SCREEN_WIDTH * SCREEN_HEIGHT, [&] {
+		Video::Clear();
+		Video::Refresh();
+		cam.Render(level);
+		Renderer::Flush();
+	}, Video::Refresh);
+
+	Renderer::Discard();
+}
+
+static Camera MakeCamera(float distance) {
+	return Camera(glm::vec3(0.0f, 0.0f, distance), 60.0f, 0.1f, distance * 4.0f);
+}
+
+int main(int argc, char** argv) {
+
+	//the crowd and point cloud sizes can be given on the command line, eg. "bench 100000 10000000"
+	size_t crowdSize = (argc > 1) ? (size_t) std::strtoul(argv[1], nullptr, 10) : 10000;
+	size_t cloudSize = (argc > 2) ? (size_t) std::strtoul(argv[2], nullptr, 10) : 1000000;
+	const char* teapotPath = "data/teapot.obj";
+
+	Video::InitHeadless(SCREEN_WIDTH, SCREEN_HEIGHT);
+	Jobs::Init();
+
+	//asset load
+	Measure("cube", "load", 1, Nothing, [] { Model m = Model::Cube(); Optimize::Stripify(m); });
+	Measure("tetrahedron", "load", 1, Nothing, [] { Model m = Model::Tetrahedron(); Optimize::Stripify(m); });
+	Measure("teapot", "load", 1, Nothing, [&] { Model m = Model::LoadObj(teapotPath, true); });
+
+	//load-time vertex cache ordering, for each bundled .obj
+	MeasureCacheOrder("cube", "data/cube.obj");
+	MeasureCacheOrder("teapot", teapotPath);
+
+	{
+		Level level;
+		Model cube = Model::Cube();
+		Optimize::Stripify(cube);
+		level.AddObject(glm::mat4(1.0f), level.AddModel(std::move(cube)));
+		Camera cam = MakeCamera(5.0f);
+		RunScene("cube", level, cam);
+	}
+	{
+		Level level;
+		Model tetrahedron = Model::Tetrahedron();
+		Optimize::Stripify(tetrahedron);
+		level.AddObject(glm::mat4(1.0f), level.AddModel(std::move(tetrahedron)));
+		Camera cam = MakeCamera(5.0f);
+		RunScene("tetrahedron", level, cam);
+	}
+	{
+		Level level;
+		level.AddObject(glm::mat4(1.0f), level.AddModel(Model::LoadObj(teapotPath, true)));
+		Camera cam = MakeCamera(8.0f);
+		RunScene("teapot", level, cam);
+	}
+	{
+		//a square grid of cubes, spaced so the camera sees all of them
+		Level level;
+		Model cube = Model::Cube();
+		Optimize::Stripify(cube);
+		ModelHandle mesh = level.AddModel(std::move(cube));
+		size_t side = (size_t) std::ceil(std::sqrt((double) crowdSize));
+		for (size_t i = 0; i < crowdSize; i++) {
+			float x = 3.0f * (float) (i % side) - 1.5f * side;
+			float y = 3.0f * (float) (i / side) - 1.5f * side;
+			level.AddObject(glm::translate(glm::mat4(1.0f), glm::vec3(x, y, 0.0f)), mesh);
+		}
+		Camera cam = MakeCamera(3.0f * side);
+		std::string name = "crowd" + std::to_string(crowdSize);
+		RunScene(name.c_str(), level, cam);
+	}
+	{
+		//a noisy spherical shell, dense like a scan of a surface
+		PointCloud cloud;
+		std::mt19937 rng(1);
+		std::normal_distribution<float> normal(0.0f, 1.0f);
+		cloud.points.resize(cloudSize);
+		for (Vector4& p : cloud.points) {
+			glm::vec3 v = glm::normalize(glm::vec3(normal(rng), normal(rng), normal(rng))) * (1.0f + 0.02f * normal(rng));
+			p = Vector4(v.x, v.y, v.z, 1.0f);
+		}
+		cloud.UpdateBounds();
+		Camera cam = MakeCamera(3.0f);
+		cam.BeginFrame();
+		glm::mat4 PVM = cam.viewProjection;
+		std::string name = "cloud" + std::to_string(cloudSize);
+
+		Measure(name.c_str(), "splat", cloudSize, [&] { cam.density.Clear(cam.GetViewport()); }, [&] { cam.density.Splat(cloud, PVM); });
+		Measure(name.c_str(), "shade", (size_t) SCREEN_WIDTH * SCREEN_HEIGHT, Renderer::Discard, [&] { cam.density.Submit(1.0f); });
+		Measure(name.c_str(), "rasterize", cloudSize, Video::Clear, [&] {
+			cam.Render(cloud, glm::mat4(1.0f));
+			Renderer::Flush();
+		});
+	}
+
+	Jobs::Deinit();
+	Video::Deinit();
+}
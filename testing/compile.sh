@@ -1 +1 @@
-g++ -std=c++23 -Wpedantic crashtest.cpp -I../include -lncurses
+g++ -std=c++23 -Wall -Wpedantic -O2 crashtest.cpp -I../include -I../3rdparty -o crashtest
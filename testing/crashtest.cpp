@@ -1,20 +1,252 @@
 //Nick Sells, 2023
-//main.cpp
+//crashtest.cpp
+//checks the matrix library against glm, then times the two against each other
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/gtx/euler_angles.hpp>
+#include <glm/matrix.hpp>
 
-#include <iostream>
 #include "matrix.h"
 
-int main(int argc, char** argv) {
+static int failures = 0;
 
-	Matrix<3,2> b = {
-		3,-5,
-		5,-3,
-		2,3
-	};
-	Matrix<2,3> c = {
-		-5,3,2,
-		-5,-5,-5
+//relative tolerance, since the inverses of badly scaled matrices have large elements
+static bool Near(float a, float b) {
+	return std::abs(a - b) <= 1e-4f * std::max(1.0f, std::max(std::abs(a), std::abs(b)));
+}
+
+static void Check(bool ok, const char* what) {
+	if (!ok) {
+		printf("FAIL: %s\n", what);
+		failures++;
+	}
+}
+
+static bool Same(const Matrix4& mat, const glm::mat4& expected) {
+	for (int row = 0; row < 4; row++)
+		for (int col = 0; col < 4; col++)
+			if (!Near(mat(row, col), expected[col][row]))
+				return false;
+	return true;
+}
+
+static bool Same(const Vector4& vec, const glm::vec4& expected) {
+	for (int i = 0; i < 4; i++)
+		if (!Near(vec[i], expected[i]))
+			return false;
+	return true;
+}
+
+//everything below is evaluated by the compiler, so the generic paths are checked without running anything
+constexpr Matrix<3,2> b = {
+	3,-5,
+	5,-3,
+	2,3
+};
+constexpr Matrix<2,3> c = {
+	-5,3,2,
+	-5,-5,-5
+};
+static_assert(b * c == Matrix<3,3>(10,34,31, -10,30,25, -25,-9,-11));
+static_assert(Matrix4::Identity().Transpose() == Matrix4::Identity());
+
+constexpr Matrix4 translation = Matrix4::Translation(Vector3(1.0f, 2.0f, 3.0f));
+constexpr Matrix4 scale = Matrix4::Scale(Vector3(2.0f, 4.0f, 8.0f));
+static_assert(translation.IsAffine());
+static_assert(translation.TransformPoint(Vector3(1.0f, 1.0f, 1.0f)) == Vector3(2.0f, 3.0f, 4.0f));
+static_assert(translation.TransformDirection(Vector3(1.0f, 1.0f, 1.0f)) == Vector3(1.0f, 1.0f, 1.0f));
+static_assert(translation * Vector4(1.0f, 1.0f, 1.0f, 1.0f) == Vector4(2.0f, 3.0f, 4.0f, 1.0f));
+static_assert(translation.AffineMultiply(scale) == translation * scale);
+static_assert(translation.AffineInverse() == Matrix4::Translation(Vector3(-1.0f, -2.0f, -3.0f)));
+static_assert((translation * scale).Inverse() == (translation * scale).AffineInverse());
+static_assert([] {
+	Vector4 points[3] = {{0.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 1.0f, 1.0f, 1.0f}, {-1.0f, 0.0f, 2.0f, 1.0f}};
+	Matrix4::Transform(scale, points, points, 3);
+	return points[2] == Vector4(-2.0f, 0.0f, 16.0f, 1.0f);
+}());
+
+static void TestAgainstGlm(void) {
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> dist(-4.0f, 4.0f);
+	auto randomVec3 = [&] { return glm::vec3(dist(rng), dist(rng), dist(rng)); };
+	auto randomVec4 = [&] { return glm::vec4(dist(rng), dist(rng), dist(rng), dist(rng)); };
+	auto randomMat4 = [&] { return glm::mat4(randomVec4(), randomVec4(), randomVec4(), randomVec4()); };
+	auto randomAffine = [&] {
+		glm::mat4 mat = glm::translate(glm::mat4(1.0f), randomVec3());
+		mat = glm::rotate(mat, dist(rng), glm::normalize(randomVec3()));
+		return glm::scale(mat, glm::vec3(1.0f) + glm::abs(randomVec3()));
 	};
-	auto bc = b*c;
-	std::cout << bc;
+
+	//odd so the batches leave a tail after the two-wide AVX loop
+	const size_t BATCH = 37;
+	std::vector<Vector4> in(BATCH), out(BATCH);
+
+	for (int trial = 0; trial < 1000; trial++) {
+		glm::mat4 gm = randomMat4();
+		glm::mat4 gn = randomMat4();
+		glm::mat4 ga = randomAffine();
+		glm::mat4 gb = randomAffine();
+		glm::vec4 gv = randomVec4();
+		Matrix4 m(gm), n(gn), a(ga), bb(gb);
+
+		Check((glm::mat4) m == gm, "round trip through glm");
+		Check(Same(m * Vector4(gv), gm * gv), "4x4 by vector");
+		Check(Same(m * n, gm * gn), "4x4 by 4x4");
+		Check(Same(m.Transpose(), glm::transpose(gm)), "transpose");
+		Check(a.IsAffine(), "affine detection");
+		Check(Same(a.AffineMultiply(bb), ga * gb), "affine multiply");
+		Check(Same(a.AffineInverse(), glm::inverse(ga)), "affine inverse");
+		Check(Same(a.Inverse(), glm::inverse(ga)), "general inverse of an affine matrix");
+
+		//random matrices can be close to singular, so check that the inverse undoes the matrix instead
+		if (std::abs(glm::determinant(gm)) > 1.0f)
+			Check(Same(m * m.Inverse(), glm::mat4(1.0f)), "general inverse");
+
+		glm::vec3 gp = randomVec3();
+		Vector3 p = a.TransformPoint(Vector3(gp));
+		Check(Same(Vector4(p[0], p[1], p[2], 1.0f), ga * glm::vec4(gp, 1.0f)), "affine point");
+
+		for (size_t i = 0; i < BATCH; i++)
+			in[i] = randomVec4();
+		Matrix4::Transform(m, in.data(), out.data(), BATCH);
+		for (size_t i = 0; i < BATCH; i++)
+			Check(Same(out[i], gm * (glm::vec4) in[i]), "batched transform");
+
+		for (size_t i = 0; i < BATCH; i++)
+			in[i][3] = 1.0f;
+		Matrix4::TransformAffine(a, in.data(), out.data(), BATCH);
+		for (size_t i = 0; i < BATCH; i++)
+			Check(Same(out[i], ga * (glm::vec4) in[i]), "batched affine transform");
+
+		//the rotation factories, with angles past a full turn either way
+		float pitch = dist(rng), yaw = dist(rng), roll = dist(rng);
+		const glm::mat4 identity(1.0f);
+		glm::mat4 gx = glm::rotate(identity, pitch, glm::vec3(1.0f, 0.0f, 0.0f));
+		glm::mat4 gy = glm::rotate(identity, yaw, glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 gz = glm::rotate(identity, roll, glm::vec3(0.0f, 0.0f, 1.0f));
+		Check(Same(Matrix4::RotationX(pitch), gx), "rotation about x");
+		Check(Same(Matrix4::RotationY(yaw), gy), "rotation about y");
+		Check(Same(Matrix4::RotationZ(roll), gz), "rotation about z");
+		//euler angles apply pitch first and roll last, ie. Z * Y * X, which glm spells eulerAngleZYX
+		Check(Same(Matrix4::Rotation(pitch, yaw, roll), gz * gy * gx), "euler rotation against composed rotations");
+		Check(Same(Matrix4::Rotation(pitch, yaw, roll), glm::eulerAngleZYX(roll, yaw, pitch)), "euler rotation against eulerAngleZYX");
+		//glm's eulerAngleXYZ is the opposite order, X * Y * Z, which is the transpose of ours with the angles negated
+		Check(Same(Matrix4::Rotation(-pitch, -yaw, -roll).Transpose(), glm::eulerAngleXYZ(pitch, yaw, roll)), "euler rotation against eulerAngleXYZ");
+
+		glm::vec3 axis = glm::normalize(randomVec3());
+		float theta = dist(rng);
+		Check(Same(Matrix4::Rotation(Vector3(axis), theta), glm::rotate(identity, theta, axis)), "axis-angle rotation");
+	}
+}
+
+//runs body until it has taken at least a quarter second and returns the average nanoseconds per op
+static double Time(size_t opsPerCall, const std::function<void()>& body) {
+	using Clock = std::chrono::steady_clock;
+	body();
+	size_t calls = 0;
+	auto start = Clock::now();
+	auto elapsed = Clock::duration::zero();
+	while (elapsed < std::chrono::milliseconds(250)) {
+		body();
+		calls++;
+		elapsed = Clock::now() - start;
+	}
+	return std::chrono::duration<double, std::nano>(elapsed).count() / (double) (calls * opsPerCall);
+}
+
+static void Report(const char* what, double glmNs, double oursNs) {
+	printf("%-28s glm %8.3f ns  ours %8.3f ns  (%.2fx)\n", what, glmNs, oursNs, glmNs / oursNs);
+}
+
+static void TestPerformance(void) {
+	const size_t COUNT = 1 << 14;
+	std::mt19937 rng(5678);
+	std::uniform_real_distribution<float> dist(-4.0f, 4.0f);
+
+	glm::mat4 gm;
+	for (int col = 0; col < 4; col++)
+		for (int row = 0; row < 4; row++)
+			gm[col][row] = dist(rng);
+	glm::mat4 ga = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 2.0f, 3.0f)), 0.5f, glm::vec3(0.0f, 1.0f, 0.0f));
+	Matrix4 m(gm), a(ga);
+
+	std::vector<glm::vec4> gin(COUNT), gout(COUNT);
+	std::vector<Vector4> in(COUNT), out(COUNT);
+	for (size_t i = 0; i < COUNT; i++) {
+		gin[i] = glm::vec4(dist(rng), dist(rng), dist(rng), 1.0f);
+		in[i] = gin[i];
+	}
+
+	double glmNs = Time(COUNT, [&] {
+		for (size_t i = 0; i < COUNT; i++)
+			gout[i] = gm * gin[i];
+	});
+	double singleNs = Time(COUNT, [&] {
+		for (size_t i = 0; i < COUNT; i++)
+			out[i] = m * in[i];
+	});
+	double batchNs = Time(COUNT, [&] { Matrix4::Transform(m, in.data(), out.data(), COUNT); });
+	double affineNs = Time(COUNT, [&] { Matrix4::TransformAffine(a, in.data(), out.data(), COUNT); });
+	Report("4x4 by vector", glmNs, singleNs);
+	Report("4x4 by vector, batched", glmNs, batchNs);
+	Report("affine by point, batched", glmNs, affineNs);
+
+	std::vector<glm::mat4> gmats(COUNT, gm), gresults(COUNT);
+	std::vector<Matrix4> mats(COUNT, m), results(COUNT);
+	glmNs = Time(COUNT, [&] {
+		for (size_t i = 0; i < COUNT; i++)
+			gresults[i] = gm * gmats[i];
+	});
+	double oursNs = Time(COUNT, [&] {
+		for (size_t i = 0; i < COUNT; i++)
+			results[i] = m * mats[i];
+	});
+	Report("4x4 by 4x4", glmNs, oursNs);
+
+	//inverting in place just flips each matrix back and forth, so the values never drift
+	for (size_t i = 0; i < COUNT; i++) {
+		gmats[i] = ga;
+		mats[i] = a;
+	}
+	glmNs = Time(COUNT, [&] {
+		for (size_t i = 0; i < COUNT; i++)
+			gmats[i] = glm::inverse(gmats[i]);
+	});
+	oursNs = Time(COUNT, [&] {
+		for (size_t i = 0; i < COUNT; i++)
+			mats[i] = mats[i].Inverse();
+	});
+	double affineInverseNs = Time(COUNT, [&] {
+		for (size_t i = 0; i < COUNT; i++)
+			mats[i] = mats[i].AffineInverse();
+	});
+	Report("inverse", glmNs, oursNs);
+	Report("inverse, affine", glmNs, affineInverseNs);
+
+	//keeps the optimizer from throwing the timed loops away
+	float sink = gout[COUNT / 2].x + out[COUNT / 2][0] + gresults[0][0][0] + results[0](0, 0) + gmats[0][0][0] + mats[0](0, 0);
+	printf("(checksum %f)\n", sink);
+}
+
+int main(int argc, char** argv) {
+	TestAgainstGlm();
+	if (failures > 0) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+
+	//"crashtest quick" skips the timings
+	if (argc < 2)
+		TestPerformance();
+	return 0;
 }